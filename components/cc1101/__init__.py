@@ -12,12 +12,19 @@ from esphome.const import (
     CONF_PROTOCOL,
     CONF_CODE,
     CONF_TEMPERATURE,
+    CONF_INTERVAL,
     UNIT_EMPTY,
     UNIT_DECIBEL_MILLIWATT,
     UNIT_CELSIUS,
+    UNIT_HERTZ,
+    UNIT_MILLISECOND,
+    UNIT_PERCENT,
     DEVICE_CLASS_SIGNAL_STRENGTH,
     DEVICE_CLASS_TEMPERATURE,
+    DEVICE_CLASS_FREQUENCY,
     STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    ENTITY_CATEGORY_DIAGNOSTIC,
 )
 
 DEPENDENCIES = ["spi"]
@@ -30,10 +37,37 @@ CONF_GDO0_PIN = "gdo0_pin"
 CONF_GDO0_ADC_ID = "gdo0_adc_id"
 CONF_BANDWIDTH = "bandwidth"
 CONF_DEVIATION = "deviation"
+CONF_DATA_RATE = "data_rate"
 CONF_MODULATION = "modulation"
 CONF_RSSI = "rssi"
 CONF_LQI = "lqi"
 CONF_CC1101_ID = "cc1101_id"
+CONF_STATS = "stats"
+CONF_TRANSACTIONS = "transactions"
+CONF_BUS_BYTES = "bus_bytes"
+CONF_BUS_TIME = "bus_time"
+CONF_WAIT_STATE_TIMEOUTS = "wait_state_timeouts"
+CONF_AFC = "afc"
+CONF_GAIN = "gain"
+CONF_OFFSET = "offset"
+CONF_KEY = "key"
+CONF_SUPERVISOR = "supervisor"
+CONF_MAX_FAILURES = "max_failures"
+CONF_RX_OVERFLOWS = "rx_overflows"
+CONF_TX_UNDERFLOWS = "tx_underflows"
+CONF_RESTARTS = "restarts"
+CONF_REINITS = "reinits"
+CONF_CCA = "cca"
+CONF_THRESHOLD = "threshold"
+CONF_BACKOFF = "backoff"
+CONF_RETRIES = "retries"
+CONF_BUSY_RATE = "busy_rate"
+CONF_BACKOFF_TIME = "backoff_time"
+CONF_WARM_BOOT = "warm_boot"
+CONF_MAX_TEMPERATURE_CHANGE = "max_temperature_change"
+CONF_MAX_VOLTAGE_CHANGE = "max_voltage_change"
+CONF_SUPPLY_ADC_ID = "supply_adc_id"
+CONF_TIME_TO_FIRST_TX = "time_to_first_tx"
 
 ns = cg.esphome_ns.namespace("cc1101")
 
@@ -47,7 +81,107 @@ MOD = {
     "MSK": 4,
 }
 
-CONFIG_SCHEMA = (
+def stats_sensor_schema(unit=UNIT_EMPTY):
+    return sensor.sensor_schema(
+        unit_of_measurement=unit,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
+
+
+STATS_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_TRANSACTIONS): stats_sensor_schema(),
+        cv.Optional(CONF_BUS_BYTES): stats_sensor_schema(),
+        cv.Optional(CONF_BUS_TIME): stats_sensor_schema(UNIT_MILLISECOND),
+        cv.Optional(CONF_WAIT_STATE_TIMEOUTS): stats_sensor_schema(),
+    }
+)
+
+AFC_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_GAIN, default="25%"): cv.All(
+            cv.percentage, cv.Range(min=0.01, max=1.0)
+        ),
+        # narrower RX bandwidth once the offset of the device or channel is known
+        cv.Optional(CONF_BANDWIDTH): cv.uint32_t,
+        cv.Optional(CONF_OFFSET): sensor.sensor_schema(
+            unit_of_measurement=UNIT_HERTZ,
+            accuracy_decimals=0,
+            device_class=DEVICE_CLASS_FREQUENCY,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+)
+
+
+SUPERVISOR_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_INTERVAL, default="1s"): cv.positive_time_period_milliseconds,
+        # failed re-inits before the component is marked failed
+        cv.Optional(CONF_MAX_FAILURES, default=3): cv.int_range(min=1, max=255),
+        cv.Optional(CONF_RX_OVERFLOWS): stats_sensor_schema(),
+        cv.Optional(CONF_TX_UNDERFLOWS): stats_sensor_schema(),
+        cv.Optional(CONF_RESTARTS): stats_sensor_schema(),
+        cv.Optional(CONF_REINITS): stats_sensor_schema(),
+    }
+)
+
+CCA_SCHEMA = cv.Schema(
+    {
+        # carrier sense threshold in dB relative to the AGC target
+        cv.Optional(CONF_THRESHOLD, default=0): cv.int_range(min=-7, max=7),
+        # the backoffs block the loop and are cut off after 100ms in total
+        cv.Optional(CONF_BACKOFF, default="5ms"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(milliseconds=1), max=cv.TimePeriod(milliseconds=20)),
+        ),
+        cv.Optional(CONF_RETRIES, default=5): cv.int_range(min=0, max=8),
+        cv.Optional(CONF_BUSY_RATE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_BACKOFF_TIME): stats_sensor_schema(UNIT_MILLISECOND),
+    }
+)
+
+WARM_BOOT_SCHEMA = cv.Schema(
+    {
+        # the temperature is only measured with gdo0_pin and gdo0_adc_id
+        cv.Optional(CONF_MAX_TEMPERATURE_CHANGE, default=5.0): cv.positive_float,
+        cv.Optional(CONF_SUPPLY_ADC_ID): cv.use_id(voltage_sampler.VoltageSampler),
+        cv.Optional(CONF_MAX_VOLTAGE_CHANGE, default="0.1V"): cv.voltage,
+        cv.Optional(CONF_TIME_TO_FIRST_TX): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+)
+
+
+def validate_afc(config):
+    if CONF_AFC in config and config[CONF_MODULATION] == "ASK":
+        raise cv.Invalid("AFC needs an FSK modulation, FREQEST is always 0 with ASK")
+    return config
+
+
+def validate_warm_boot(config):
+    if CONF_WARM_BOOT not in config:
+        return config
+    temperature = CONF_GDO0_PIN in config and CONF_GDO0_ADC_ID in config
+    if not temperature and CONF_SUPPLY_ADC_ID not in config[CONF_WARM_BOOT]:
+        # with nothing measured the saved calibration can't be checked
+        raise cv.Invalid("warm_boot needs gdo0_pin and gdo0_adc_id, or supply_adc_id")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(CC1101),
@@ -57,6 +191,7 @@ CONFIG_SCHEMA = (
             cv.Optional(CONF_DEVIATION, default=0x47): cv.hex_uint8_t,
             cv.Optional(CONF_FREQUENCY, default=433920): cv.uint32_t,
             cv.Optional(CONF_MODULATION, default="ASK"): cv.enum(MOD),
+            cv.Optional(CONF_DATA_RATE): cv.int_range(min=600, max=500000),
             cv.Optional(CONF_RSSI): sensor.sensor_schema(
                 unit_of_measurement=UNIT_DECIBEL_MILLIWATT,
                 accuracy_decimals=0,
@@ -74,10 +209,17 @@ CONFIG_SCHEMA = (
                 device_class=DEVICE_CLASS_TEMPERATURE,
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
+            cv.Optional(CONF_STATS): STATS_SCHEMA,
+            cv.Optional(CONF_AFC): AFC_SCHEMA,
+            cv.Optional(CONF_SUPERVISOR, default={}): SUPERVISOR_SCHEMA,
+            cv.Optional(CONF_CCA): CCA_SCHEMA,
+            cv.Optional(CONF_WARM_BOOT): WARM_BOOT_SCHEMA,
         }
     )
     .extend(cv.polling_component_schema("60s"))
-    .extend(spi.spi_device_schema(cs_pin_required=True))
+    .extend(spi.spi_device_schema(cs_pin_required=True)),
+    validate_afc,
+    validate_warm_boot,
 )
 
 
@@ -96,6 +238,8 @@ async def to_code(config):
     cg.add(var.set_config_frequency(config[CONF_FREQUENCY]))
     cg.add(var.set_config_modulation(config[CONF_MODULATION]))
     cg.add(var.set_config_deviation(config[CONF_DEVIATION]))
+    if CONF_DATA_RATE in config:
+        cg.add(var.set_config_data_rate(config[CONF_DATA_RATE]))
     if CONF_RSSI in config:
         rssi = await sensor.new_sensor(config[CONF_RSSI])
         cg.add(var.set_config_rssi_sensor(rssi))
@@ -105,10 +249,83 @@ async def to_code(config):
     if CONF_TEMPERATURE in config:
         temperature = await sensor.new_sensor(config[CONF_TEMPERATURE])
         cg.add(var.set_config_temperature_sensor(temperature))
+    if CONF_AFC in config:
+        afc = config[CONF_AFC]
+        cg.add(var.set_config_afc(True))
+        cg.add(var.set_config_afc_gain(afc[CONF_GAIN]))
+        if CONF_BANDWIDTH in afc:
+            cg.add(var.set_config_afc_bandwidth(afc[CONF_BANDWIDTH]))
+        if CONF_OFFSET in afc:
+            sens = await sensor.new_sensor(afc[CONF_OFFSET])
+            cg.add(var.set_config_afc_offset_sensor(sens))
+    supervisor = config[CONF_SUPERVISOR]
+    cg.add(var.set_config_supervisor_interval(supervisor[CONF_INTERVAL]))
+    cg.add(var.set_config_max_failures(supervisor[CONF_MAX_FAILURES]))
+    if CONF_RX_OVERFLOWS in supervisor:
+        sens = await sensor.new_sensor(supervisor[CONF_RX_OVERFLOWS])
+        cg.add(var.set_config_rx_overflows_sensor(sens))
+    if CONF_TX_UNDERFLOWS in supervisor:
+        sens = await sensor.new_sensor(supervisor[CONF_TX_UNDERFLOWS])
+        cg.add(var.set_config_tx_underflows_sensor(sens))
+    if CONF_RESTARTS in supervisor:
+        sens = await sensor.new_sensor(supervisor[CONF_RESTARTS])
+        cg.add(var.set_config_restarts_sensor(sens))
+    if CONF_REINITS in supervisor:
+        sens = await sensor.new_sensor(supervisor[CONF_REINITS])
+        cg.add(var.set_config_reinits_sensor(sens))
+    if CONF_CCA in config:
+        cca = config[CONF_CCA]
+        cg.add(var.set_config_cca(True))
+        cg.add(var.set_config_cca_threshold(cca[CONF_THRESHOLD]))
+        cg.add(var.set_config_cca_backoff(cca[CONF_BACKOFF]))
+        cg.add(var.set_config_cca_retries(cca[CONF_RETRIES]))
+        if CONF_BUSY_RATE in cca:
+            sens = await sensor.new_sensor(cca[CONF_BUSY_RATE])
+            cg.add(var.set_config_cca_busy_rate_sensor(sens))
+        if CONF_BACKOFF_TIME in cca:
+            sens = await sensor.new_sensor(cca[CONF_BACKOFF_TIME])
+            cg.add(var.set_config_cca_backoff_time_sensor(sens))
+    if CONF_WARM_BOOT in config:
+        warm_boot = config[CONF_WARM_BOOT]
+        cg.add(var.set_config_warm_boot(True))
+        cg.add(
+            var.set_config_warm_boot_max_temperature_change(
+                warm_boot[CONF_MAX_TEMPERATURE_CHANGE]
+            )
+        )
+        cg.add(
+            var.set_config_warm_boot_max_voltage_change(
+                warm_boot[CONF_MAX_VOLTAGE_CHANGE]
+            )
+        )
+        if CONF_SUPPLY_ADC_ID in warm_boot:
+            supply_adc = await cg.get_variable(warm_boot[CONF_SUPPLY_ADC_ID])
+            cg.add(var.set_config_supply_adc_pin(supply_adc))
+        if CONF_TIME_TO_FIRST_TX in warm_boot:
+            sens = await sensor.new_sensor(warm_boot[CONF_TIME_TO_FIRST_TX])
+            cg.add(var.set_config_time_to_first_tx_sensor(sens))
+    if CONF_STATS in config:
+        # counters are compiled out unless at least one radio asks for them
+        cg.add_define("USE_CC1101_STATS")
+        stats = config[CONF_STATS]
+        if CONF_TRANSACTIONS in stats:
+            sens = await sensor.new_sensor(stats[CONF_TRANSACTIONS])
+            cg.add(var.set_config_transactions_sensor(sens))
+        if CONF_BUS_BYTES in stats:
+            sens = await sensor.new_sensor(stats[CONF_BUS_BYTES])
+            cg.add(var.set_config_bus_bytes_sensor(sens))
+        if CONF_BUS_TIME in stats:
+            sens = await sensor.new_sensor(stats[CONF_BUS_TIME])
+            cg.add(var.set_config_bus_time_sensor(sens))
+        if CONF_WAIT_STATE_TIMEOUTS in stats:
+            sens = await sensor.new_sensor(stats[CONF_WAIT_STATE_TIMEOUTS])
+            cg.add(var.set_config_wait_state_timeouts_sensor(sens))
 
 
 BeginTxAction = ns.class_("BeginTxAction", automation.Action)
 EndTxAction = ns.class_("EndTxAction", automation.Action)
+DumpStatsAction = ns.class_("DumpStatsAction", automation.Action)
+AFCUpdateAction = ns.class_("AFCUpdateAction", automation.Action)
 
 CC1101_ACTION_SCHEMA = maybe_simple_id(
     {
@@ -118,12 +335,32 @@ CC1101_ACTION_SCHEMA = maybe_simple_id(
 
 @automation.register_action("cc1101.begin_tx", BeginTxAction, CC1101_ACTION_SCHEMA)
 @automation.register_action("cc1101.end_tx", EndTxAction, CC1101_ACTION_SCHEMA)
+@automation.register_action("cc1101.dump_stats", DumpStatsAction, CC1101_ACTION_SCHEMA)
 async def cc1101_action_to_code(config, action_id, template_arg, args):
     var = cg.new_Pvariable(action_id, template_arg)
     await cg.register_parented(var, config[CONF_ID])
     return var
 
 
+@automation.register_action(
+    "cc1101.afc_update",
+    AFCUpdateAction,
+    cv.Schema(
+        {
+            cv.GenerateID(CONF_ID): cv.use_id(CC1101),
+            # remote device or channel the offset is kept for
+            cv.Optional(CONF_KEY, default=0): cv.templatable(cv.uint8_t),
+        }
+    ),
+)
+async def afc_update_action_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    key = await cg.templatable(config[CONF_KEY], args, cg.uint8)
+    cg.add(var.set_key(key))
+    return var
+
+
 CC1101RawAction = ns.class_("CC1101RawAction", remote_base.RCSwitchRawAction)
 
 CC1101_TRANSMIT_SCHEMA = (
@@ -24,10 +24,12 @@
   TODO: Libretiny? (USE_LIBRETINY)
 */
 
+#include "esphome/core/application.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 #include "cc1101.h"
 #include "cc1101defs.h"
+#include <algorithm>
 #include <climits>
 
 #ifdef USE_ARDUINO
@@ -47,19 +49,64 @@ namespace cc1101 {
 
 static const char *const TAG = "cc1101";
 
-// 300 - 348, 387 - 464              -30   -20   -15   -10     0     5     7    10
-static const uint8_t PA_TABLE_315[8]{0x12, 0x0D, 0x1C, 0x34, 0x51, 0x85, 0xCB, 0xC2};
-static const uint8_t PA_TABLE_433[8]{0x12, 0x0E, 0x1D, 0x34, 0x60, 0x84, 0xC8, 0xC0};
-// 779 - 899.99                       -30   -20   -15   -10    -6     0     5     7    10    12
-static const uint8_t PA_TABLE_868[10]{0x03, 0x17, 0x1D, 0x26, 0x37, 0x50, 0x86, 0xCD, 0xC5, 0xC0};
-// 900 - 928                          -30   -20   -15   -10    -6     0     5     7    10    11
-static const uint8_t PA_TABLE_915[10]{0x03, 0x0E, 0x1E, 0x27, 0x38, 0x8E, 0x84, 0xCC, 0xC3, 0xC0};
+// listen before talk blocks the loop, the backoffs of one transmission never add up to more than this
+static const uint32_t CCA_MAX_BACKOFF_TIME = 100;  // ms
+
+// PA table per band, value[i] is used when the requested power is <= dbm[i], the last entry covers everything above
+struct PABand {
+  int min_frequency;  // KHz, inclusive
+  int max_frequency;  // KHz, exclusive
+  uint8_t count;
+  int8_t dbm[10];
+  uint8_t value[10];
+};
+
+static constexpr PABand PA_BANDS[4]{
+    // 300 - 348
+    {300000, 348001, 8, {-30, -20, -15, -10, 0, 5, 7, 10}, {0x12, 0x0D, 0x1C, 0x34, 0x51, 0x85, 0xCB, 0xC2}},
+    // 378 - 464
+    {378000, 464001, 8, {-30, -20, -15, -10, 0, 5, 7, 10}, {0x12, 0x0E, 0x1D, 0x34, 0x60, 0x84, 0xC8, 0xC0}},
+    // 779 - 899.99
+    {779000,
+     900000,
+     10,
+     {-30, -20, -15, -10, -6, 0, 5, 7, 10, 12},
+     {0x03, 0x17, 0x1D, 0x26, 0x37, 0x50, 0x86, 0xCD, 0xC5, 0xC0}},
+    // 900 - 928
+    {900000,
+     928001,
+     10,
+     {-30, -20, -15, -10, -6, 0, 5, 7, 10, 11},
+     {0x03, 0x0E, 0x1E, 0x27, 0x38, 0x8E, 0x84, 0xCC, 0xC3, 0xC0}},
+};
+
+static constexpr int find_pa_band(int frequency) {
+  for (int i = 0; i < 4; i++) {
+    if (frequency >= PA_BANDS[i].min_frequency && frequency < PA_BANDS[i].max_frequency)
+      return i;
+  }
+  return -1;
+}
+
+static constexpr uint8_t find_pa_value(const PABand &band, int8_t pa) {
+  for (uint8_t i = 0; i + 1 < band.count; i++) {
+    if (pa <= band.dbm[i])
+      return band.value[i];
+  }
+  return band.value[band.count - 1];
+}
+
+static_assert(find_pa_band(433920) == 1, "433 band lookup");
+static_assert(find_pa_band(900000) == 3, "915 band lookup");
+static_assert(find_pa_value(PA_BANDS[1], 12) == 0xC0, "433 max power");
+static_assert(find_pa_value(PA_BANDS[2], -6) == 0x37, "868 -6 dBm");
 
 CC1101::CC1101() {
   this->gdo0_ = nullptr;
   this->gdo0_adc_ = nullptr;
   this->bandwidth_ = 200;
   this->frequency_ = 433920;
+  this->data_rate_ = 0;
   this->rssi_sensor_ = nullptr;
   this->lqi_sensor_ = nullptr;
   this->temperature_sensor_ = nullptr;
@@ -70,12 +117,66 @@ CC1101::CC1101() {
   this->last_lqi_ = INT_MIN;
   this->last_temperature_ = NAN;
 
+  this->bus_listener_ = nullptr;
+  this->bus_start_ = 0;
+  this->tx_granted_ = false;
+  this->tx_refused_ = false;
+
+  this->afc_ = false;
+  this->afc_gain_ = 0.25f;
+  this->afc_bandwidth_ = 0;
+  this->afc_offset_sensor_ = nullptr;
+  memset(this->afc_entries_, 0, sizeof(this->afc_entries_));
+  this->afc_count_ = 0;
+  this->afc_offset_ = 0;
+  this->afc_locked_ = false;
+  this->last_afc_offset_ = NAN;
+  this->fsctrl0_ = 0;
+
+  this->cca_ = false;
+  this->cca_threshold_ = 0;
+  this->cca_backoff_ = 5;
+  this->cca_retries_ = 5;
+  this->cca_busy_rate_sensor_ = nullptr;
+  this->cca_backoff_time_sensor_ = nullptr;
+  this->cca_attempts_ = 0;
+  this->cca_busy_ = 0;
+  this->cca_backoff_time_ = 0;
+
+  this->supervisor_interval_ = 1000;
+  this->max_failures_ = 3;
+  this->failures_ = 0;
+  memset(&this->recoveries_, 0, sizeof(this->recoveries_));
+  memset(&this->register_image_, 0, sizeof(this->register_image_));
+  this->image_valid_ = false;
+  this->rx_overflows_sensor_ = nullptr;
+  this->tx_underflows_sensor_ = nullptr;
+  this->restarts_sensor_ = nullptr;
+  this->reinits_sensor_ = nullptr;
+
+  this->warm_boot_ = false;
+  this->warm_boot_max_temperature_change_ = 5.0f;
+  this->warm_boot_max_voltage_change_ = 0.1f;
+  this->supply_adc_ = nullptr;
+  this->time_to_first_tx_sensor_ = nullptr;
+  this->warm_calibration_ = false;
+  this->first_tx_ = true;
+
+#ifdef USE_CC1101_STATS
+  memset(&this->stats_, 0, sizeof(this->stats_));
+  this->transactions_sensor_ = nullptr;
+  this->bus_bytes_sensor_ = nullptr;
+  this->bus_time_sensor_ = nullptr;
+  this->wait_state_timeouts_sensor_ = nullptr;
+#endif
+
   this->mode_ = false;
   this->chan_ = 0;
   this->pa_ = 12;
   this->last_pa_ = -1;
   this->m4rxbw_ = 0;
   this->trxstate_ = 0;
+  this->transmitting_ = false;
 
   this->clb_[0][0] = 24;
   this->clb_[0][1] = 28;
@@ -100,6 +201,8 @@ void CC1101::set_config_deviation(uint8_t deviation) { deviation_ = deviation; }
 
 void CC1101::set_config_frequency(int frequency) { frequency_ = frequency; }
 
+void CC1101::set_config_data_rate(int data_rate) { data_rate_ = data_rate; }
+
 void CC1101::set_config_modulation(int modulation) { modulation_ = modulation; }
 
 void CC1101::set_config_rssi_sensor(sensor::Sensor *rssi_sensor) { rssi_sensor_ = rssi_sensor; }
@@ -110,6 +213,82 @@ void CC1101::set_config_temperature_sensor(sensor::Sensor *temperature_sensor) {
   temperature_sensor_ = temperature_sensor;
 }
 
+void CC1101::set_config_afc(bool afc) { afc_ = afc; }
+
+void CC1101::set_config_afc_gain(float afc_gain) { afc_gain_ = afc_gain; }
+
+void CC1101::set_config_afc_bandwidth(int afc_bandwidth) { afc_bandwidth_ = afc_bandwidth; }
+
+void CC1101::set_config_afc_offset_sensor(sensor::Sensor *afc_offset_sensor) {
+  afc_offset_sensor_ = afc_offset_sensor;
+}
+
+void CC1101::set_config_cca(bool cca) { cca_ = cca; }
+
+void CC1101::set_config_cca_threshold(int8_t cca_threshold) { cca_threshold_ = cca_threshold; }
+
+void CC1101::set_config_cca_backoff(uint32_t cca_backoff) { cca_backoff_ = cca_backoff; }
+
+void CC1101::set_config_cca_retries(uint8_t cca_retries) { cca_retries_ = cca_retries; }
+
+void CC1101::set_config_cca_busy_rate_sensor(sensor::Sensor *cca_busy_rate_sensor) {
+  cca_busy_rate_sensor_ = cca_busy_rate_sensor;
+}
+
+void CC1101::set_config_cca_backoff_time_sensor(sensor::Sensor *cca_backoff_time_sensor) {
+  cca_backoff_time_sensor_ = cca_backoff_time_sensor;
+}
+
+void CC1101::set_config_supervisor_interval(uint32_t supervisor_interval) {
+  supervisor_interval_ = supervisor_interval;
+}
+
+void CC1101::set_config_max_failures(uint8_t max_failures) { max_failures_ = max_failures; }
+
+void CC1101::set_config_rx_overflows_sensor(sensor::Sensor *rx_overflows_sensor) {
+  rx_overflows_sensor_ = rx_overflows_sensor;
+}
+
+void CC1101::set_config_tx_underflows_sensor(sensor::Sensor *tx_underflows_sensor) {
+  tx_underflows_sensor_ = tx_underflows_sensor;
+}
+
+void CC1101::set_config_restarts_sensor(sensor::Sensor *restarts_sensor) { restarts_sensor_ = restarts_sensor; }
+
+void CC1101::set_config_reinits_sensor(sensor::Sensor *reinits_sensor) { reinits_sensor_ = reinits_sensor; }
+
+void CC1101::set_config_warm_boot(bool warm_boot) { warm_boot_ = warm_boot; }
+
+void CC1101::set_config_warm_boot_max_temperature_change(float max_temperature_change) {
+  warm_boot_max_temperature_change_ = max_temperature_change;
+}
+
+void CC1101::set_config_warm_boot_max_voltage_change(float max_voltage_change) {
+  warm_boot_max_voltage_change_ = max_voltage_change;
+}
+
+void CC1101::set_config_supply_adc_pin(voltage_sampler::VoltageSampler *pin) { supply_adc_ = pin; }
+
+void CC1101::set_config_time_to_first_tx_sensor(sensor::Sensor *time_to_first_tx_sensor) {
+  time_to_first_tx_sensor_ = time_to_first_tx_sensor;
+}
+
+void CC1101::set_bus_listener(CC1101BusListener *listener) { bus_listener_ = listener; }
+
+#ifdef USE_CC1101_STATS
+void CC1101::set_config_transactions_sensor(sensor::Sensor *transactions_sensor) {
+  transactions_sensor_ = transactions_sensor;
+}
+
+void CC1101::set_config_bus_bytes_sensor(sensor::Sensor *bus_bytes_sensor) { bus_bytes_sensor_ = bus_bytes_sensor; }
+
+void CC1101::set_config_bus_time_sensor(sensor::Sensor *bus_time_sensor) { bus_time_sensor_ = bus_time_sensor; }
+
+void CC1101::set_config_wait_state_timeouts_sensor(sensor::Sensor *wait_state_timeouts_sensor) {
+  wait_state_timeouts_sensor_ = wait_state_timeouts_sensor;
+}
+#endif
+
 void CC1101::setup() {
   if (this->gdo0_ != nullptr) {
 #ifdef USE_ESP8266
@@ -121,15 +300,25 @@ void CC1101::setup() {
 #endif
   }
 
-  // datasheet 19.1.2
-  this->cs_->digital_write(true);
-  delayMicroseconds(1);
-  this->cs_->digital_write(false);
-  delayMicroseconds(1);
-  this->cs_->digital_write(true);
-  delayMicroseconds(41);
-  this->cs_->digital_write(false);
-  delayMicroseconds(5000);
+  CC1101WarmBoot image;
+  bool warm = false;
+
+  if (this->warm_boot_) {
+    this->warm_boot_pref_ = global_preferences->make_preference<CC1101WarmBoot>(this->warm_boot_hash_());
+    warm = this->warm_boot_pref_.load(&image);
+  }
+
+  if (!warm) {
+    // datasheet 19.1.2
+    this->cs_->digital_write(true);
+    delayMicroseconds(1);
+    this->cs_->digital_write(false);
+    delayMicroseconds(1);
+    this->cs_->digital_write(true);
+    delayMicroseconds(41);
+    this->cs_->digital_write(false);
+    delayMicroseconds(5000);
+  }
 
   this->spi_setup();
 
@@ -139,6 +328,27 @@ void CC1101::setup() {
     return;
   }
 
+  this->set_interval("supervisor", this->supervisor_interval_, [this]() { this->supervise_(); });
+
+  if (warm) {
+    this->warm_boot_restore_(image);
+    return;
+  }
+
+  this->cold_init_();
+
+  if (this->failures_ != 0) {
+    // a state change timed out, the registers can't be trusted as an image, the supervisor redoes the cold init
+    ESP_LOGW(TAG, "CC1101 initialized with %u failures, not keeping the register image", (unsigned) this->failures_);
+    return;
+  }
+
+  this->keep_register_image_();
+
+  ESP_LOGI(TAG, "CC1101 initialized.");
+}
+
+void CC1101::cold_init_() {
   // ELECHOUSE_cc1101.Init();
 
   this->write_register_(CC1101_FSCTRL1, 0x06);
@@ -152,10 +362,18 @@ void CC1101::setup() {
   this->write_register_(CC1101_DEVIATN, this->deviation_);
   this->write_register_(CC1101_FREND1, 0x56);
   this->write_register_(CC1101_MCSM0, 0x18);
-  this->write_register_(CC1101_FOCCFG, 0x16);
+  // FOC_BS_CS_GATE with AFC: the estimate freezes when carrier sense drops at the end of a burst, FREQEST read
+  // afterwards is still the burst's offset and not noise the loop kept tracking
+  this->write_register_(CC1101_FOCCFG, this->afc_ ? 0x36 : 0x16);
   this->write_register_(CC1101_BSCFG, 0x1C);
   this->write_register_(CC1101_AGCCTRL2, 0xC7);
-  this->write_register_(CC1101_AGCCTRL1, 0x00);
+  if (this->cca_) {
+    // CCA_MODE 01: STX in RX is only accepted while RSSI is below the carrier sense threshold
+    this->write_register_(CC1101_MCSM1, 0x10);
+    this->write_register_(CC1101_AGCCTRL1, this->cca_threshold_ & 0x0F);
+  } else {
+    this->write_register_(CC1101_AGCCTRL1, 0x00);
+  }
   this->write_register_(CC1101_AGCCTRL0, 0xB2);
   this->write_register_(CC1101_FSCAL3, 0xE9);
   this->write_register_(CC1101_FSCAL2, 0x2A);
@@ -180,10 +398,21 @@ void CC1101::setup() {
   //
 
   this->set_state_(CC1101_SRX);
+}
 
-  //
+void CC1101::keep_register_image_() {
+  float temperature = NAN;
+  if (this->warm_boot_ && this->gdo0_ != nullptr && this->gdo0_adc_ != nullptr) {
+    temperature = this->get_temperature_();
+  }
 
-  ESP_LOGI(TAG, "CC1101 initialized.");
+  // kept for re-init by the supervisor
+  this->read_register_image_();
+  this->image_valid_ = true;
+
+  if (this->warm_boot_) {
+    this->warm_boot_save_(temperature, this->get_supply_voltage_());
+  }
 }
 
 void CC1101::update() {
@@ -213,6 +442,62 @@ void CC1101::update() {
       this->last_temperature_ = temperature;
     }
   }
+
+  if (this->afc_locked_ && this->trxstate_ == CC1101_SRX && !this->afc_narrow_(this->afc_offset_, millis())) {
+    // the devices the filter was narrowed for went silent, others may be outside it
+    ESP_LOGD(TAG, "AFC tracked devices not heard, widening the filter");
+    this->set_state_(CC1101_SIDLE);
+    this->set_afc_locked_(false);
+    this->set_state_(CC1101_SRX);
+  }
+
+  if (this->afc_offset_sensor_ != nullptr) {
+    // Hz, FREQEST and FSCTRL0 share the same resolution
+    float offset = this->afc_offset_ * (float) CC1101_FXOSC / (1 << 14);
+    if (offset != this->last_afc_offset_) {
+      this->afc_offset_sensor_->publish_state(offset);
+      this->last_afc_offset_ = offset;
+    }
+  }
+
+  if (this->cca_busy_rate_sensor_ != nullptr && this->cca_attempts_ > 0) {
+    this->cca_busy_rate_sensor_->publish_state(100.0f * this->cca_busy_ / this->cca_attempts_);
+  }
+  if (this->cca_backoff_time_sensor_ != nullptr) {
+    this->cca_backoff_time_sensor_->publish_state(this->cca_backoff_time_);
+  }
+
+  if (this->rx_overflows_sensor_ != nullptr) {
+    this->rx_overflows_sensor_->publish_state(this->recoveries_.rx_overflows);
+  }
+  if (this->tx_underflows_sensor_ != nullptr) {
+    this->tx_underflows_sensor_->publish_state(this->recoveries_.tx_underflows);
+  }
+  if (this->restarts_sensor_ != nullptr) {
+    this->restarts_sensor_->publish_state(this->recoveries_.restarts);
+  }
+  if (this->reinits_sensor_ != nullptr) {
+    this->reinits_sensor_->publish_state(this->recoveries_.reinits);
+  }
+
+#ifdef USE_CC1101_STATS
+  if (this->transactions_sensor_ != nullptr) {
+    this->transactions_sensor_->publish_state(this->stats_.transactions);
+  }
+  if (this->bus_bytes_sensor_ != nullptr) {
+    this->bus_bytes_sensor_->publish_state(this->stats_.bytes);
+  }
+  if (this->bus_time_sensor_ != nullptr) {
+    uint64_t bus_time = 0;
+    for (uint64_t t : this->stats_.bus_time) {
+      bus_time += t;
+    }
+    this->bus_time_sensor_->publish_state(bus_time / 1000);
+  }
+  if (this->wait_state_timeouts_sensor_ != nullptr) {
+    this->wait_state_timeouts_sensor_->publish_state(this->stats_.wait_state_timeouts);
+  }
+#endif
 }
 
 void CC1101::dump_config() {
@@ -221,9 +506,43 @@ void CC1101::dump_config() {
   LOG_PIN("  CC1101 GDO0: ", this->gdo0_);
   ESP_LOGCONFIG(TAG, "  CC1101 Bandwith: %d KHz", this->bandwidth_);
   ESP_LOGCONFIG(TAG, "  CC1101 Frequency: %d KHz", this->frequency_);
+  if (this->data_rate_ > 0) {
+    ESP_LOGCONFIG(TAG, "  CC1101 Data rate: %d Baud (DRATE_E %d DRATE_M %d)", this->data_rate_, this->m4dara_,
+                  this->m3dara_);
+  }
   LOG_SENSOR("  ", "RSSI", this->rssi_sensor_);
   LOG_SENSOR("  ", "LQI", this->lqi_sensor_);
   LOG_SENSOR("  ", "Temperature sensor", this->temperature_sensor_);
+  ESP_LOGCONFIG(TAG, "  CC1101 Supervisor: every %u ms, failed after %u failures", (unsigned) this->supervisor_interval_,
+                this->max_failures_);
+  LOG_SENSOR("  ", "RX overflows", this->rx_overflows_sensor_);
+  LOG_SENSOR("  ", "TX underflows", this->tx_underflows_sensor_);
+  LOG_SENSOR("  ", "Restarts", this->restarts_sensor_);
+  LOG_SENSOR("  ", "Re-inits", this->reinits_sensor_);
+  if (this->cca_) {
+    ESP_LOGCONFIG(TAG, "  CC1101 CCA: threshold %d dB, backoff %u ms, %u retries", this->cca_threshold_,
+                  (unsigned) this->cca_backoff_, this->cca_retries_);
+    LOG_SENSOR("  ", "CCA busy rate", this->cca_busy_rate_sensor_);
+    LOG_SENSOR("  ", "CCA backoff time", this->cca_backoff_time_sensor_);
+  }
+  if (this->warm_boot_) {
+    ESP_LOGCONFIG(TAG, "  CC1101 Warm boot: max temperature change %.1f C, max voltage change %.2f V",
+                  this->warm_boot_max_temperature_change_, this->warm_boot_max_voltage_change_);
+    LOG_SENSOR("  ", "Time to first TX", this->time_to_first_tx_sensor_);
+  }
+  if (this->afc_) {
+    ESP_LOGCONFIG(TAG, "  CC1101 AFC: gain %.2f", this->afc_gain_);
+    if (this->afc_bandwidth_ > 0) {
+      ESP_LOGCONFIG(TAG, "  CC1101 AFC Bandwith: %d KHz", this->afc_bandwidth_);
+    }
+    LOG_SENSOR("  ", "AFC offset", this->afc_offset_sensor_);
+  }
+#ifdef USE_CC1101_STATS
+  LOG_SENSOR("  ", "Transactions", this->transactions_sensor_);
+  LOG_SENSOR("  ", "Bus bytes", this->bus_bytes_sensor_);
+  LOG_SENSOR("  ", "Bus time", this->bus_time_sensor_);
+  LOG_SENSOR("  ", "Wait state timeouts", this->wait_state_timeouts_sensor_);
+#endif
 }
 
 bool CC1101::reset_() {
@@ -241,17 +560,48 @@ bool CC1101::reset_() {
   return this->version_ > 0;
 }
 
-void CC1101::strobe_(uint8_t cmd) {
+void CC1101::bus_begin_() {
+#ifdef USE_CC1101_STATS
+  this->bus_start_ = micros();
+#else
+  if (this->bus_listener_ != nullptr) {
+    this->bus_start_ = micros();
+  }
+#endif
   this->enable();
-  this->write_byte(cmd);
+}
+
+void CC1101::bus_end_(CC1101BusOp op, size_t bytes) {
   this->disable();
+#ifdef USE_CC1101_STATS
+  uint32_t duration = micros() - this->bus_start_;
+  this->stats_.transactions++;
+  this->stats_.bytes += bytes;
+  this->stats_.bus_time[op] += duration;
+  if (op == CC1101_BUS_OP_STROBE) {
+    this->stats_.strobes++;
+  }
+  if (this->bus_listener_ != nullptr) {
+    this->bus_listener_->on_bus_transaction(this, duration);
+  }
+#else
+  if (this->bus_listener_ != nullptr) {
+    this->bus_listener_->on_bus_transaction(this, micros() - this->bus_start_);
+  }
+#endif
+}
+
+void CC1101::strobe_(uint8_t cmd) {
+  this->bus_begin_();
+  this->write_byte(cmd);
+  this->bus_end_(CC1101_BUS_OP_STROBE, 1);
 }
 
 uint8_t CC1101::read_register_(uint8_t reg) {
-  this->enable();
+  this->bus_begin_();
   this->write_byte(reg);
   uint8_t value = this->transfer_byte(0);
-  this->disable();
+  this->bus_end_(CC1101_BUS_OP_READ, 2);
   return value;
 }
 
@@ -260,16 +610,16 @@ uint8_t CC1101::read_config_register_(uint8_t reg) { return this->read_register_
 uint8_t CC1101::read_status_register_(uint8_t reg) { return this->read_register_(reg | CC1101_READ_BURST); }
 
 void CC1101::read_register_burst_(uint8_t reg, uint8_t *buffer, size_t length) {
-  this->enable();
+  this->bus_begin_();
   this->write_byte(reg | CC1101_READ_BURST);
   this->read_array(buffer, length);
-  this->disable();
+  this->bus_end_(CC1101_BUS_OP_READ, 1 + length);
 }
 void CC1101::write_register_(uint8_t reg, uint8_t *value, size_t length) {
-  this->enable();
+  this->bus_begin_();
   this->write_byte(reg);
   this->transfer_array(value, length);
-  this->disable();
+  this->bus_end_(CC1101_BUS_OP_WRITE, 1 + length);
 }
 
 void CC1101::write_register_(uint8_t reg, uint8_t value) {
@@ -383,6 +733,13 @@ float CC1101::get_temperature_() {
   return NAN;
 }
 
+float CC1101::get_supply_voltage_() {
+  if (this->supply_adc_ == nullptr) {
+    return NAN;
+  }
+  return this->supply_adc_->sample();
+}
+
 void CC1101::set_mode_(bool s) {
   this->mode_ = s;
 
@@ -390,14 +747,21 @@ void CC1101::set_mode_(bool s) {
     this->write_register_(CC1101_IOCFG2, 0x0B);
     this->write_register_(CC1101_IOCFG0, 0x06);
     this->write_register_(CC1101_PKTCTRL0, 0x05);
-    this->write_register_(CC1101_MDMCFG3, 0xF8);
-    this->write_register_(CC1101_MDMCFG4, 11 + this->m4rxbw_);
+    this->m4dara_ = 11;
+    this->m3dara_ = 0xF8;
   } else {
     this->write_register_(CC1101_IOCFG2, 0x0D);
     this->write_register_(CC1101_IOCFG0, 0x0D);
     this->write_register_(CC1101_PKTCTRL0, 0x32);
-    this->write_register_(CC1101_MDMCFG3, 0x93);
-    this->write_register_(CC1101_MDMCFG4, 7 + this->m4rxbw_);
+    this->m4dara_ = 7;
+    this->m3dara_ = 0x93;
+  }
+
+  if (this->data_rate_ > 0) {
+    this->set_data_rate_(this->data_rate_);
+  } else {
+    this->write_register_(CC1101_MDMCFG3, this->m3dara_);
+    this->write_register_(CC1101_MDMCFG4, this->m4dara_ + this->m4rxbw_);
   }
 
   this->set_modulation_(this->modulation_);
@@ -443,97 +807,17 @@ void CC1101::set_modulation_(uint8_t m) {
 void CC1101::set_pa_(int8_t pa) {
   this->pa_ = pa;
 
-  int a;
-
-  if (this->frequency_ >= 300000 && this->frequency_ <= 348000) {
-    if (pa <= -30) {
-      a = PA_TABLE_315[0];
-    } else if (pa > -30 && pa <= -20) {
-      a = PA_TABLE_315[1];
-    } else if (pa > -20 && pa <= -15) {
-      a = PA_TABLE_315[2];
-    } else if (pa > -15 && pa <= -10) {
-      a = PA_TABLE_315[3];
-    } else if (pa > -10 && pa <= 0) {
-      a = PA_TABLE_315[4];
-    } else if (pa > 0 && pa <= 5) {
-      a = PA_TABLE_315[5];
-    } else if (pa > 5 && pa <= 7) {
-      a = PA_TABLE_315[6];
-    } else {
-      a = PA_TABLE_315[7];
-    }
-    this->last_pa_ = 1;
-  } else if (this->frequency_ >= 378000 && this->frequency_ <= 464000) {
-    if (pa <= -30) {
-      a = PA_TABLE_433[0];
-    } else if (pa > -30 && pa <= -20) {
-      a = PA_TABLE_433[1];
-    } else if (pa > -20 && pa <= -15) {
-      a = PA_TABLE_433[2];
-    } else if (pa > -15 && pa <= -10) {
-      a = PA_TABLE_433[3];
-    } else if (pa > -10 && pa <= 0) {
-      a = PA_TABLE_433[4];
-    } else if (pa > 0 && pa <= 5) {
-      a = PA_TABLE_433[5];
-    } else if (pa > 5 && pa <= 7) {
-      a = PA_TABLE_433[6];
-    } else {
-      a = PA_TABLE_433[7];
-    }
-    this->last_pa_ = 2;
-  } else if (this->frequency_ >= 779000 && this->frequency_ < 900000) {
-    if (pa <= -30) {
-      a = PA_TABLE_868[0];
-    } else if (pa > -30 && pa <= -20) {
-      a = PA_TABLE_868[1];
-    } else if (pa > -20 && pa <= -15) {
-      a = PA_TABLE_868[2];
-    } else if (pa > -15 && pa <= -10) {
-      a = PA_TABLE_868[3];
-    } else if (pa > -10 && pa <= -6) {
-      a = PA_TABLE_868[4];
-    } else if (pa > -6 && pa <= 0) {
-      a = PA_TABLE_868[5];
-    } else if (pa > 0 && pa <= 5) {
-      a = PA_TABLE_868[6];
-    } else if (pa > 5 && pa <= 7) {
-      a = PA_TABLE_868[7];
-    } else if (pa > 7 && pa <= 10) {
-      a = PA_TABLE_868[8];
-    } else {
-      a = PA_TABLE_868[9];
-    }
-    this->last_pa_ = 3;
-  } else if (this->frequency_ >= 900000 && this->frequency_ <= 928000) {
-    if (pa <= -30) {
-      a = PA_TABLE_915[0];
-    } else if (pa > -30 && pa <= -20) {
-      a = PA_TABLE_915[1];
-    } else if (pa > -20 && pa <= -15) {
-      a = PA_TABLE_915[2];
-    } else if (pa > -15 && pa <= -10) {
-      a = PA_TABLE_915[3];
-    } else if (pa > -10 && pa <= -6) {
-      a = PA_TABLE_915[4];
-    } else if (pa > -6 && pa <= 0) {
-      a = PA_TABLE_915[5];
-    } else if (pa > 0 && pa <= 5) {
-      a = PA_TABLE_915[6];
-    } else if (pa > 5 && pa <= 7) {
-      a = PA_TABLE_915[7];
-    } else if (pa > 7 && pa <= 10) {
-      a = PA_TABLE_915[8];
-    } else {
-      a = PA_TABLE_915[9];
-    }
-    this->last_pa_ = 4;
-  } else {
+  int band = find_pa_band(this->frequency_);
+
+  if (band < 0) {
     ESP_LOGE(TAG, "CC1101 set_pa(%d) frequency out of range: %d", pa, this->frequency_);
     return;
   }
 
+  uint8_t a = find_pa_value(PA_BANDS[band], pa);
+
+  this->last_pa_ = band + 1;
+
   if (this->modulation_ == 2) {
     this->pa_table_[0] = 0;
     this->pa_table_[1] = a;
@@ -586,7 +870,8 @@ void CC1101::set_frequency_(int f) {
   mhz = (float) f / 1000;
 
   if (mhz >= 300 && mhz <= 348) {
-    this->write_register_(CC1101_FSCTRL0, map(mhz, 300, 348, this->clb_[0][0], this->clb_[0][1]));
+    this->fsctrl0_ = map(mhz, 300, 348, this->clb_[0][0], this->clb_[0][1]);
+    this->write_fsctrl0_();
 
     if (mhz < 322.88) {
       this->write_register_(CC1101_TEST0, 0x0B);
@@ -603,7 +888,8 @@ void CC1101::set_frequency_(int f) {
         this->set_pa_(this->pa_);
     }
   } else if (mhz >= 378 && mhz <= 464) {
-    this->write_register_(CC1101_FSCTRL0, map(mhz, 378, 464, this->clb_[1][0], this->clb_[1][1]));
+    this->fsctrl0_ = map(mhz, 378, 464, this->clb_[1][0], this->clb_[1][1]);
+    this->write_fsctrl0_();
 
     if (mhz < 430.5) {
       this->write_register_(CC1101_TEST0, 0x0B);
@@ -620,7 +906,8 @@ void CC1101::set_frequency_(int f) {
         this->set_pa_(this->pa_);
     }
   } else if (mhz >= 779 && mhz <= 899.99) {
-    this->write_register_(CC1101_FSCTRL0, map(mhz, 779, 899, this->clb_[2][0], this->clb_[2][1]));
+    this->fsctrl0_ = map(mhz, 779, 899, this->clb_[2][0], this->clb_[2][1]);
+    this->write_fsctrl0_();
 
     if (mhz < 861) {
       this->write_register_(CC1101_TEST0, 0x0B);
@@ -637,7 +924,8 @@ void CC1101::set_frequency_(int f) {
         this->set_pa_(this->pa_);
     }
   } else if (mhz >= 900 && mhz <= 928) {
-    this->write_register_(CC1101_FSCTRL0, map(mhz, 900, 928, this->clb_[3][0], this->clb_[3][1]));
+    this->fsctrl0_ = map(mhz, 900, 928, this->clb_[3][0], this->clb_[3][1]);
+    this->write_fsctrl0_();
     this->write_register_(CC1101_TEST0, 0x09);
 
     uint8_t s = this->read_status_register_(CC1101_FSCAL2);
@@ -651,6 +939,11 @@ void CC1101::set_frequency_(int f) {
   }
 }
 
+void CC1101::write_fsctrl0_() {
+  int value = (int8_t) this->fsctrl0_ + this->afc_offset_;
+  this->write_register_(CC1101_FSCTRL0, (uint8_t) clamp(value, -128, 127));
+}
+
 void CC1101::set_clb_(uint8_t b, uint8_t s, uint8_t e) {
   if (b < 4) {
     this->clb_[b][0] = s;
@@ -659,9 +952,7 @@ void CC1101::set_clb_(uint8_t b, uint8_t s, uint8_t e) {
 }
 
 void CC1101::set_rxbw_(int bw) {
-  this->bandwidth_ = bw;
-
-  float f = (float) this->bandwidth_;
+  float f = (float) bw;
 
   int s1 = 3;
   int s2 = 3;
@@ -683,6 +974,32 @@ void CC1101::set_rxbw_(int bw) {
   this->write_register_(CC1101_MDMCFG4, this->m4rxbw_ + this->m4dara_);
 }
 
+void CC1101::set_data_rate_(int rate) {
+  this->data_rate_ = rate;
+
+  // datasheet 12: rate = (256 + DRATE_M) * 2^DRATE_E * f_xosc / 2^28
+
+  uint8_t e = 0;
+  uint64_t m;
+
+  do {
+    m = ((static_cast<uint64_t>(rate) << (28 - e)) + CC1101_FXOSC / 2) / CC1101_FXOSC;
+  } while (m >= 512 && ++e < 16);
+
+  if (m < 256) {
+    m = 256;  // clamp to the slowest rate
+  } else if (m >= 512) {
+    e = 15;
+    m = 511;  // clamp to the fastest rate
+  }
+
+  this->m4dara_ = e;
+  this->m3dara_ = m - 256;
+
+  this->write_register_(CC1101_MDMCFG3, this->m3dara_);
+  this->write_register_(CC1101_MDMCFG4, this->m4rxbw_ + this->m4dara_);
+}
+
 void CC1101::set_state_(uint8_t state) {
   if (state == CC1101_STX || state == CC1101_SRX || state == CC1101_SPWD) {
     this->set_state_(CC1101_SIDLE);
@@ -691,30 +1008,46 @@ void CC1101::set_state_(uint8_t state) {
   ESP_LOGV(TAG, "set_state_(0x%02X)", state);
 
   this->trxstate_ = state;
+  this->transmitting_ = state == CC1101_STX;
   this->strobe_(state);
   this->wait_state_(state);
 }
 
 bool CC1101::wait_state_(uint8_t state) {
+#ifdef USE_CC1101_STATS
+  uint32_t start_us = micros();
+#endif
   uint32_t start = millis();
   while ((millis() - start) < 1000) {
+#ifdef USE_CC1101_STATS
+    this->stats_.wait_state_loops++;
+#endif
     uint8_t s = this->read_status_register_(CC1101_MARCSTATE) & 0x1f;
+    bool done;
     if (state == CC1101_SIDLE || state == CC1101_SRES) {
-      if (s == CC1101_MARCSTATE_IDLE)
-        return true;
+      done = s == CC1101_MARCSTATE_IDLE;
     } else if (state == CC1101_SRX) {
-      if (s == CC1101_MARCSTATE_RX || s == CC1101_MARCSTATE_RX_END || s == CC1101_MARCSTATE_RXTX_SWITCH)
-        return true;
+      done = s == CC1101_MARCSTATE_RX || s == CC1101_MARCSTATE_RX_END || s == CC1101_MARCSTATE_RXTX_SWITCH;
     } else if (state == CC1101_STX) {
-      if (s == CC1101_MARCSTATE_TX || s == CC1101_MARCSTATE_TX_END || s == CC1101_MARCSTATE_TXRX_SWITCH)
-        return true;
+      done = s == CC1101_MARCSTATE_TX || s == CC1101_MARCSTATE_TX_END || s == CC1101_MARCSTATE_TXRX_SWITCH;
     } else {
-      return true;  // else if TODO
+      done = true;  // else if TODO
+    }
+    if (done) {
+#ifdef USE_CC1101_STATS
+      this->stats_.wait_state_time += micros() - start_us;
+#endif
+      return true;
     }
     delayMicroseconds(1);
   }
-  mark_failed();
-  ESP_LOGE(TAG, "CC1101 modem wait state timeout. Check connection.");
+#ifdef USE_CC1101_STATS
+  this->stats_.wait_state_timeouts++;
+  this->stats_.wait_state_time += micros() - start_us;
+#endif
+  // handled by the supervisor, mark_failed only after re-init did not help either
+  this->failures_++;
+  ESP_LOGE(TAG, "CC1101 modem wait state timeout.");
   return false;
 }
 
@@ -734,8 +1067,38 @@ void CC1101::split_mdmcfg4_() {
   this->m4dara_ = calc & 0x0f;
 }
 
-void CC1101::begin_tx() {
-  this->set_state_(CC1101_STX);
+bool CC1101::begin_tx() {
+  this->tx_refused_ = false;
+  if (this->bus_listener_ != nullptr) {
+    if (!this->bus_listener_->on_tx_request(this)) {
+      ESP_LOGD(TAG, "CC1101 TX refused, another radio is transmitting");
+      this->tx_refused_ = true;
+      return false;
+    }
+    this->tx_granted_ = true;
+  }
+
+  if (!this->cca_) {
+    this->set_state_(CC1101_STX);
+  } else if (!this->listen_before_talk_()) {
+    ESP_LOGW(TAG, "CC1101 TX dropped, channel busy");
+    if (this->tx_granted_) {
+      this->tx_granted_ = false;
+      this->bus_listener_->on_tx_release(this);
+    }
+    return false;
+  }
+
+  if (this->first_tx_) {
+    this->first_tx_ = false;
+    uint32_t time_to_first_tx = millis();
+    this->defer([this, time_to_first_tx]() {
+      ESP_LOGD(TAG, "CC1101 first TX %u ms after boot", (unsigned) time_to_first_tx);
+      if (this->time_to_first_tx_sensor_ != nullptr) {
+        this->time_to_first_tx_sensor_->publish_state(time_to_first_tx);
+      }
+    });
+  }
 
   if (this->gdo0_ != nullptr) {
 #ifdef USE_ESP8266
@@ -747,6 +1110,15 @@ void CC1101::begin_tx() {
     this->gdo0_->pin_mode(gpio::FLAG_OUTPUT);
 #endif
   }
+
+  return true;
+}
+
+bool CC1101::wait_tx(std::function<void()> &&resume) {
+  if (!this->tx_refused_ || this->bus_listener_ == nullptr) {
+    return false;
+  }
+  return this->bus_listener_->on_tx_wait(this, std::move(resume));
 }
 
 void CC1101::end_tx() {
@@ -761,7 +1133,340 @@ void CC1101::end_tx() {
 #endif
   }
 
+  // the restored calibration got the first frame out, going back to RX calibrates again
+  this->end_warm_calibration_();
+
+  this->set_state_(CC1101_SRX);
+
+  if (this->tx_granted_) {
+    this->tx_granted_ = false;
+    this->bus_listener_->on_tx_release(this);
+  }
+}
+
+void CC1101::dump_stats() {
+#ifdef USE_CC1101_STATS
+  const CC1101Stats &st = this->stats_;
+  ESP_LOGI(TAG, "CC1101 stats:");
+  ESP_LOGI(TAG, "  Transactions: %u, bytes: %u, strobes: %u", (unsigned) st.transactions, (unsigned) st.bytes,
+           (unsigned) st.strobes);
+  ESP_LOGI(TAG, "  Bus time: strobe %llu us, read %llu us, write %llu us",
+           (unsigned long long) st.bus_time[CC1101_BUS_OP_STROBE], (unsigned long long) st.bus_time[CC1101_BUS_OP_READ],
+           (unsigned long long) st.bus_time[CC1101_BUS_OP_WRITE]);
+  ESP_LOGI(TAG, "  Wait state: %u loops, %u timeouts, %llu us", (unsigned) st.wait_state_loops,
+           (unsigned) st.wait_state_timeouts, (unsigned long long) st.wait_state_time);
+#else
+  ESP_LOGW(TAG, "CC1101 stats are not enabled");
+#endif
+  const CC1101Recoveries &rc = this->recoveries_;
+  ESP_LOGI(TAG, "CC1101 recoveries: %u RX overflows, %u TX underflows, %u restarts, %u re-inits",
+           (unsigned) rc.rx_overflows, (unsigned) rc.tx_underflows, (unsigned) rc.restarts, (unsigned) rc.reinits);
+}
+
+CC1101AFCEntry *CC1101::find_afc_entry_(uint8_t key) {
+  CC1101AFCEntry *oldest = nullptr;
+  for (uint8_t i = 0; i < this->afc_count_; i++) {
+    CC1101AFCEntry *entry = &this->afc_entries_[i];
+    if (entry->key == key) {
+      return entry;
+    }
+    if (oldest == nullptr || entry->last_update < oldest->last_update) {
+      oldest = entry;
+    }
+  }
+  if (this->afc_count_ < AFC_ENTRIES) {
+    oldest = &this->afc_entries_[this->afc_count_++];
+  }
+  // new or the least recently heard one is replaced
+  oldest->key = key;
+  oldest->samples = 0;
+  oldest->offset = 0;
+  return oldest;
+}
+
+void CC1101::afc_update(uint8_t key) {
+  if (!this->afc_ || this->trxstate_ != CC1101_SRX) {
+    return;
+  }
+
+  // residual offset of the last packet on top of the correction already in FSCTRL0, always 0 with ASK/OOK
+  int8_t freqest = (int8_t) this->read_status_register_(CC1101_FREQEST);
+
+  // FOC_LIMIT is BW/4, in FREQEST steps of f_xosc / 2^14 that is 2^9 / ((4 + CHANBW_M) * 2^CHANBW_E). A reading at
+  // the limit is saturated, the real offset is unknown
+  int foc_limit = 512 / ((4 + ((this->m4rxbw_ >> 4) & 3)) << (this->m4rxbw_ >> 6));
+  if (std::abs(freqest) >= foc_limit) {
+    ESP_LOGV(TAG, "afc key %u freqest %d at the FOC limit, ignored", key, freqest);
+    return;
+  }
+
+  CC1101AFCEntry *entry = this->find_afc_entry_(key);
+  float offset = this->afc_offset_ + freqest;
+  if (entry->samples == 0) {
+    entry->offset = offset;
+  } else {
+    entry->offset += this->afc_gain_ * (offset - entry->offset);
+  }
+  if (entry->samples < UINT8_MAX) {
+    entry->samples++;
+  }
+  uint32_t now = millis();
+  entry->last_update = now;
+
+  ESP_LOGV(TAG, "afc key %u freqest %d offset %.1f", key, freqest, entry->offset);
+
+  // the most recently heard device or channel is tracked
+  int8_t afc_offset = (int8_t) clamp((int) lroundf(entry->offset), -128, 127);
+  bool afc_locked = this->afc_narrow_(afc_offset, now);
+  if (afc_offset == this->afc_offset_ && afc_locked == this->afc_locked_) {
+    return;
+  }
+
+  // FSCTRL0 and MDMCFG4 are written in IDLE, going back to RX recalibrates (MCSM0)
+  this->set_state_(CC1101_SIDLE);
+  this->afc_offset_ = afc_offset;
+  this->write_fsctrl0_();
+  this->set_afc_locked_(afc_locked);
+  this->set_state_(CC1101_SRX);
+}
+
+bool CC1101::afc_narrow_(int8_t afc_offset, uint32_t now) const {
+  if (this->afc_bandwidth_ <= 0) {
+    return false;
+  }
+  // every device heard recently must stay within the FOC range of the narrow filter around afc_offset, and at least
+  // one of them must have settled
+  float margin = this->afc_bandwidth_ * 1000.0f / 4 / ((float) CC1101_FXOSC / (1 << 14));
+  bool settled = false;
+  for (uint8_t i = 0; i < this->afc_count_; i++) {
+    const CC1101AFCEntry &entry = this->afc_entries_[i];
+    if (now - entry.last_update > AFC_TRACK_TIMEOUT) {
+      continue;
+    }
+    if (std::fabs(entry.offset - afc_offset) > margin) {
+      return false;
+    }
+    settled |= entry.samples >= AFC_LOCK_SAMPLES;
+  }
+  return settled;
+}
+
+void CC1101::set_afc_locked_(bool afc_locked) {
+  if (afc_locked == this->afc_locked_) {
+    return;
+  }
+  // the offset is known, the narrower filter only needs to cover the residual
+  this->afc_locked_ = afc_locked;
+  this->set_rxbw_(afc_locked ? this->afc_bandwidth_ : this->bandwidth_);
+}
+
+bool CC1101::listen_before_talk_() {
+  if (this->trxstate_ != CC1101_SRX) {
+    this->set_state_(CC1101_SRX);
+  }
+
+  uint32_t start = millis();
+
+  for (uint8_t attempt = 0;; attempt++) {
+    this->cca_attempts_++;
+
+    // STX from RX, the radio stays in RX if the channel is busy
+    this->strobe_(CC1101_STX);
+    uint32_t start_us = micros();
+    do {
+      uint8_t s = this->read_status_register_(CC1101_MARCSTATE) & 0x1f;
+      if (s != CC1101_MARCSTATE_RX) {
+        this->trxstate_ = CC1101_STX;
+        this->transmitting_ = true;
+        this->cca_backoff_time_ += millis() - start;
+        return this->wait_state_(CC1101_STX);
+      }
+    } while (micros() - start_us < 500);
+
+    this->cca_busy_++;
+
+    if (attempt >= this->cca_retries_) {
+      break;
+    }
+
+    uint32_t elapsed = millis() - start;
+    if (elapsed >= CCA_MAX_BACKOFF_TIME) {
+      break;
+    }
+
+    // random backoff, the window doubles after every busy assessment
+    uint32_t window = this->cca_backoff_ << std::min<uint8_t>(attempt, 4);
+    uint32_t backoff = std::min(random_uint32() % window + 1, CCA_MAX_BACKOFF_TIME - elapsed);
+    ESP_LOGV(TAG, "channel busy, backoff %u ms", (unsigned) backoff);
+    delay(backoff);
+  }
+
+  this->cca_backoff_time_ += millis() - start;
+  return false;
+}
+
+uint32_t CC1101::warm_boot_hash_() {
+  // a different config or firmware may program different registers
+  return fnv1_hash(
+      str_sprintf("cc1101 %08X %s", (unsigned) App.get_config_hash(), this->cs_->dump_summary().c_str()));
+}
+
+static bool warm_boot_unchanged(float saved, float now, float max_change) {
+  if (std::isnan(saved) || std::isnan(now)) {
+    return std::isnan(saved) && std::isnan(now);
+  }
+  return std::fabs(now - saved) <= max_change;
+}
+
+void CC1101::warm_boot_restore_(const CC1101WarmBoot &image) {
+  // saved after an init without failures
+  this->register_image_ = image;
+  this->image_valid_ = true;
+  this->write_register_image_();
+
+  // what set_mode_, set_modulation_, set_pa_, set_rxbw_ and set_frequency_ leave behind on a cold boot
+  memcpy(this->pa_table_, image.pa_table, sizeof(this->pa_table_));
+  this->m4rxbw_ = image.registers[CC1101_MDMCFG4] & 0xf0;
+  this->m4dara_ = image.registers[CC1101_MDMCFG4] & 0x0f;
+  this->m3dara_ = image.registers[CC1101_MDMCFG3];
+  this->m2dcoff_ = image.registers[CC1101_MDMCFG2] & 0x80;
+  this->m2modfm_ = image.registers[CC1101_MDMCFG2] & 0x70;
+  this->m2manch_ = image.registers[CC1101_MDMCFG2] & 0x08;
+  this->m2syncm_ = image.registers[CC1101_MDMCFG2] & 0x07;
+  this->frend0_ = image.registers[CC1101_FREND0];
+  this->fsctrl0_ = image.registers[CC1101_FSCTRL0];
+  this->last_pa_ = find_pa_band(this->frequency_) + 1;
+
+  float temperature = NAN;
+  if (this->gdo0_ != nullptr && this->gdo0_adc_ != nullptr) {
+    temperature = this->get_temperature_();
+  }
+  float voltage = this->get_supply_voltage_();
+
+  // the saved FSCAL values are only valid near the temperature and voltage they were calibrated at, with nothing
+  // measured there is no telling
+  bool measured = !std::isnan(temperature) || !std::isnan(voltage);
+  bool stable = measured &&
+                warm_boot_unchanged(image.temperature, temperature, this->warm_boot_max_temperature_change_) &&
+                warm_boot_unchanged(image.voltage, voltage, this->warm_boot_max_voltage_change_);
+
+  if (stable) {
+    // FS_AUTOCAL off until the first transmission is done
+    this->write_register_(CC1101_MCSM0, image.registers[CC1101_MCSM0] & ~0x30);
+    this->warm_calibration_ = true;
+    this->set_timeout("warm_calibration", WARM_CALIBRATION_TIMEOUT, [this]() {
+      // still in RX, the first transmission would have ended it, going through IDLE calibrates
+      if (this->warm_calibration_ && this->trxstate_ == CC1101_SRX) {
+        this->end_warm_calibration_();
+        this->set_state_(CC1101_SRX);
+      }
+    });
+  }
+
   this->set_state_(CC1101_SRX);
+
+  if (!stable && this->failures_ == 0) {
+    this->read_register_image_();
+    this->warm_boot_save_(temperature, voltage);
+  }
+
+  ESP_LOGI(TAG, "CC1101 initialized from saved registers%s.", stable ? "" : ", recalibrated");
+}
+
+void CC1101::warm_boot_save_(float temperature, float voltage) {
+  this->register_image_.temperature = temperature;
+  this->register_image_.voltage = voltage;
+  if (!this->warm_boot_pref_.save(&this->register_image_)) {
+    ESP_LOGW(TAG, "CC1101 failed to save registers for warm boot");
+  }
+}
+
+void CC1101::end_warm_calibration_() {
+  if (!this->warm_calibration_) {
+    return;
+  }
+  this->warm_calibration_ = false;
+  this->write_register_(CC1101_MCSM0, this->register_image_.registers[CC1101_MCSM0]);
+}
+
+void CC1101::read_register_image_() {
+  this->read_register_burst_(CC1101_IOCFG2, this->register_image_.registers, sizeof(this->register_image_.registers));
+  this->read_register_burst_(CC1101_PATABLE, this->register_image_.pa_table, sizeof(this->register_image_.pa_table));
+}
+
+void CC1101::write_register_image_() {
+  // transfer_array overwrites the buffer with what it reads, the image is written from a copy
+  CC1101WarmBoot image = this->register_image_;
+  this->write_register_burst_(CC1101_IOCFG2, image.registers, sizeof(image.registers));
+  this->write_register_burst_(CC1101_PATABLE, image.pa_table, sizeof(image.pa_table));
+}
+
+bool CC1101::reinit_() {
+  uint8_t failures = this->failures_;
+  if (!this->reset_()) {
+    return false;
+  }
+  // the image and the cold init both leave the registers as setup programs them, before any AFC correction
+  this->afc_offset_ = 0;
+  this->afc_locked_ = false;
+  this->warm_calibration_ = false;
+  if (this->image_valid_) {
+    this->write_register_image_();
+    this->set_state_(CC1101_SRX);
+  } else {
+    this->cold_init_();
+  }
+  if (this->failures_ != failures) {
+    return false;
+  }
+  if (!this->image_valid_) {
+    this->keep_register_image_();
+  }
+  return true;
+}
+
+void CC1101::supervise_() {
+  if (this->trxstate_ != CC1101_SRX) {
+    return;  // transmitting, the next check will catch anything left behind
+  }
+
+  if (this->failures_ == 0) {
+    uint8_t s = this->read_status_register_(CC1101_MARCSTATE) & 0x1f;
+    if (s == CC1101_MARCSTATE_RX || s == CC1101_MARCSTATE_RX_END || s == CC1101_MARCSTATE_RXTX_SWITCH) {
+      return;
+    }
+    if (s == CC1101_MARCSTATE_RXFIFO_OVERFLOW) {
+      ESP_LOGW(TAG, "CC1101 RX FIFO overflow, flushing");
+      this->recoveries_.rx_overflows++;
+      this->strobe_(CC1101_SFRX);
+    } else if (s == CC1101_MARCSTATE_TXFIFO_UNDERFLOW) {
+      ESP_LOGW(TAG, "CC1101 TX FIFO underflow, flushing");
+      this->recoveries_.tx_underflows++;
+      this->strobe_(CC1101_SFTX);
+    } else {
+      ESP_LOGW(TAG, "CC1101 in state 0x%02X instead of RX, restarting RX", s);
+      this->recoveries_.restarts++;
+    }
+    this->set_state_(CC1101_SRX);
+    if (this->failures_ == 0) {
+      return;
+    }
+  }
+
+  if (this->failures_ >= this->max_failures_) {
+    ESP_LOGE(TAG, "CC1101 did not recover after %u failures. Check connection.", this->failures_);
+    this->mark_failed();
+    return;
+  }
+
+  ESP_LOGW(TAG, "CC1101 re-initializing %s", this->image_valid_ ? "from the register image" : "from scratch");
+  this->recoveries_.reinits++;
+  uint8_t failures = this->failures_;
+  if (this->reinit_()) {
+    this->failures_ = 0;
+  } else if (this->failures_ == failures) {
+    this->failures_++;
+  }
 }
 
 }  // namespace cc1101
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <functional>
+#include "esphome/core/defines.h"
 #include "esphome/core/component.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/spi/spi.h"
 #include "esphome/components/remote_base/rc_switch_protocol.h"
@@ -9,6 +12,62 @@
 namespace esphome {
 namespace cc1101 {
 
+class CC1101;
+
+// Implemented by cc1101_manager to arbitrate several radios sharing one SPI bus
+class CC1101BusListener {
+ public:
+  virtual ~CC1101BusListener() = default;
+  virtual void on_bus_transaction(CC1101 *radio, uint32_t duration_us) = 0;
+  virtual bool on_tx_request(CC1101 *radio) = 0;
+  virtual void on_tx_release(CC1101 *radio) = 0;
+  // resume is called once the TX window was released, false if it can't be queued
+  virtual bool on_tx_wait(CC1101 *radio, std::function<void()> &&resume) = 0;
+};
+
+enum CC1101BusOp : uint8_t {
+  CC1101_BUS_OP_STROBE = 0,
+  CC1101_BUS_OP_READ,
+  CC1101_BUS_OP_WRITE,
+  CC1101_BUS_OP_COUNT,
+};
+
+#ifdef USE_CC1101_STATS
+struct CC1101Stats {
+  uint32_t transactions;
+  uint32_t bytes;
+  uint32_t strobes;
+  uint32_t wait_state_loops;
+  uint32_t wait_state_timeouts;
+  uint64_t wait_state_time;                // us, 32 bits wrap after 71 minutes
+  uint64_t bus_time[CC1101_BUS_OP_COUNT];  // us, per CC1101BusOp
+};
+#endif
+
+// Counted by the supervisor, per kind of recovery
+struct CC1101Recoveries {
+  uint32_t rx_overflows;   // SFRX
+  uint32_t tx_underflows;  // SFTX
+  uint32_t restarts;       // back to RX from an unexpected state
+  uint32_t reinits;        // reset and register image written back
+};
+
+// Frequency offset of one remote device or channel, in FREQEST steps (FXOSC / 2^14)
+struct CC1101AFCEntry {
+  uint8_t key;
+  uint8_t samples;
+  float offset;
+  uint32_t last_update;  // ms
+};
+
+// Register image saved after calibration, restored in one burst on the next boot
+struct CC1101WarmBoot {
+  uint8_t registers[0x2F];  // IOCFG2 - TEST0, including FSCAL3 - FSCAL0
+  uint8_t pa_table[8];
+  float temperature;  // C, NAN if not measured
+  float voltage;      // V, NAN if not measured
+};
+
 class CC1101 : public PollingComponent,
                public spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST, spi::CLOCK_POLARITY_LOW, spi::CLOCK_PHASE_LEADING,
                                      spi::DATA_RATE_1KHZ> {
@@ -17,6 +76,7 @@ class CC1101 : public PollingComponent,
   voltage_sampler::VoltageSampler *gdo0_adc_;
   int bandwidth_;
   int frequency_;
+  int data_rate_;
   sensor::Sensor *rssi_sensor_;
   sensor::Sensor *lqi_sensor_;
   sensor::Sensor *temperature_sensor_;
@@ -27,6 +87,87 @@ class CC1101 : public PollingComponent,
   int last_lqi_;
   float last_temperature_;
 
+  CC1101BusListener *bus_listener_;
+  uint32_t bus_start_;
+  bool tx_granted_;
+  bool tx_refused_;  // the last begin_tx was refused by the bus listener
+
+  void bus_begin_();
+  void bus_end_(CC1101BusOp op, size_t bytes);
+
+  static constexpr uint8_t AFC_ENTRIES = 8;
+  static constexpr uint8_t AFC_LOCK_SAMPLES = 4;
+  static constexpr uint32_t AFC_TRACK_TIMEOUT = 300000;  // ms, entries not heard for longer are no longer tracked
+
+  bool afc_;
+  float afc_gain_;
+  int afc_bandwidth_;
+  sensor::Sensor *afc_offset_sensor_;
+  CC1101AFCEntry afc_entries_[AFC_ENTRIES];
+  uint8_t afc_count_;
+  int8_t afc_offset_;  // currently added to FSCTRL0
+  bool afc_locked_;
+  float last_afc_offset_;
+  uint8_t fsctrl0_;  // band calibration from set_frequency_
+
+  bool warm_boot_;
+  float warm_boot_max_temperature_change_;
+  float warm_boot_max_voltage_change_;
+  voltage_sampler::VoltageSampler *supply_adc_;
+  sensor::Sensor *time_to_first_tx_sensor_;
+  ESPPreferenceObject warm_boot_pref_;
+  bool warm_calibration_;  // FS_AUTOCAL is off, the restored FSCAL values are used
+  static constexpr uint32_t WARM_CALIBRATION_TIMEOUT = 60000;  // ms, a node that doesn't transmit calibrates then
+  bool first_tx_;
+
+  bool cca_;
+  int8_t cca_threshold_;   // dB, relative to the AGC target (CARRIER_SENSE_ABS_THR)
+  uint32_t cca_backoff_;   // ms, first backoff window
+  uint8_t cca_retries_;
+  sensor::Sensor *cca_busy_rate_sensor_;
+  sensor::Sensor *cca_backoff_time_sensor_;
+  uint32_t cca_attempts_;
+  uint32_t cca_busy_;
+  uint32_t cca_backoff_time_;  // ms
+
+  bool listen_before_talk_();
+
+  uint32_t supervisor_interval_;
+  uint8_t max_failures_;
+  uint8_t failures_;  // wait state timeouts and failed re-inits since the last recovery
+  CC1101Recoveries recoveries_;
+  CC1101WarmBoot register_image_;  // read back after setup
+  bool image_valid_;               // register_image_ was read back after an init without failures
+  sensor::Sensor *rx_overflows_sensor_;
+  sensor::Sensor *tx_underflows_sensor_;
+  sensor::Sensor *restarts_sensor_;
+  sensor::Sensor *reinits_sensor_;
+
+  void cold_init_();
+  void keep_register_image_();
+  void read_register_image_();
+  void write_register_image_();
+  bool reinit_();
+  void supervise_();
+
+  uint32_t warm_boot_hash_();
+  void warm_boot_restore_(const CC1101WarmBoot &image);
+  void warm_boot_save_(float temperature, float voltage);
+  void end_warm_calibration_();
+
+  CC1101AFCEntry *find_afc_entry_(uint8_t key);
+  bool afc_narrow_(int8_t afc_offset, uint32_t now) const;
+  void set_afc_locked_(bool afc_locked);
+  void write_fsctrl0_();
+
+#ifdef USE_CC1101_STATS
+  CC1101Stats stats_;
+  sensor::Sensor *transactions_sensor_;
+  sensor::Sensor *bus_bytes_sensor_;
+  sensor::Sensor *bus_time_sensor_;
+  sensor::Sensor *wait_state_timeouts_sensor_;
+#endif
+
   bool reset_();
   void strobe_(uint8_t cmd);
   uint8_t read_register_(uint8_t reg);
@@ -48,6 +189,7 @@ class CC1101 : public PollingComponent,
   uint8_t last_pa_;
   uint8_t m4rxbw_;
   uint8_t m4dara_;
+  uint8_t m3dara_;
   uint8_t m2dcoff_;
   uint8_t m2modfm_;
   uint8_t m2manch_;
@@ -56,6 +198,7 @@ class CC1101 : public PollingComponent,
   uint8_t m1pre_;
   uint8_t m1chsp_;
   uint8_t trxstate_;
+  volatile bool transmitting_;  // trxstate_ is STX, read from interrupts
   uint8_t deviation_;
   uint8_t clb_[4][2];
   uint8_t pa_table_[8];
@@ -63,6 +206,7 @@ class CC1101 : public PollingComponent,
   int get_rssi_();
   int get_lqi_();
   float get_temperature_();
+  float get_supply_voltage_();
 
   void set_mode_(bool s);
   void set_frequency_(int f);
@@ -70,6 +214,7 @@ class CC1101 : public PollingComponent,
   void set_pa_(int8_t pa);
   void set_clb_(uint8_t b, uint8_t s, uint8_t e);
   void set_rxbw_(int bw);
+  void set_data_rate_(int rate);
   void set_state_(uint8_t state);
   bool wait_state_(uint8_t state);
 
@@ -83,23 +228,80 @@ class CC1101 : public PollingComponent,
   void set_config_gdo0_adc_pin(voltage_sampler::VoltageSampler *pin);
   void set_config_bandwidth(int bandwidth);
   void set_config_frequency(int frequency);
+  void set_config_data_rate(int data_rate);
   void set_config_modulation(int modulation);
   void set_config_deviation(uint8_t deviation);
   void set_config_rssi_sensor(sensor::Sensor *rssi_sensor);
   void set_config_lqi_sensor(sensor::Sensor *lqi_sensor);
   void set_config_temperature_sensor(sensor::Sensor *temperature_sensor);
+  void set_config_afc(bool afc);
+  void set_config_afc_gain(float afc_gain);
+  void set_config_afc_bandwidth(int afc_bandwidth);
+  void set_config_afc_offset_sensor(sensor::Sensor *afc_offset_sensor);
+  void set_config_cca(bool cca);
+  void set_config_cca_threshold(int8_t cca_threshold);
+  void set_config_cca_backoff(uint32_t cca_backoff);
+  void set_config_cca_retries(uint8_t cca_retries);
+  void set_config_cca_busy_rate_sensor(sensor::Sensor *cca_busy_rate_sensor);
+  void set_config_cca_backoff_time_sensor(sensor::Sensor *cca_backoff_time_sensor);
+  void set_config_supervisor_interval(uint32_t supervisor_interval);
+  void set_config_max_failures(uint8_t max_failures);
+  void set_config_rx_overflows_sensor(sensor::Sensor *rx_overflows_sensor);
+  void set_config_tx_underflows_sensor(sensor::Sensor *tx_underflows_sensor);
+  void set_config_restarts_sensor(sensor::Sensor *restarts_sensor);
+  void set_config_reinits_sensor(sensor::Sensor *reinits_sensor);
+  void set_config_warm_boot(bool warm_boot);
+  void set_config_warm_boot_max_temperature_change(float max_temperature_change);
+  void set_config_warm_boot_max_voltage_change(float max_voltage_change);
+  void set_config_supply_adc_pin(voltage_sampler::VoltageSampler *pin);
+  void set_config_time_to_first_tx_sensor(sensor::Sensor *time_to_first_tx_sensor);
+  void set_bus_listener(CC1101BusListener *listener);
+#ifdef USE_CC1101_STATS
+  void set_config_transactions_sensor(sensor::Sensor *transactions_sensor);
+  void set_config_bus_bytes_sensor(sensor::Sensor *bus_bytes_sensor);
+  void set_config_bus_time_sensor(sensor::Sensor *bus_time_sensor);
+  void set_config_wait_state_timeouts_sensor(sensor::Sensor *wait_state_timeouts_sensor);
+#endif
 
   void setup() override;
   void update() override;
   void dump_config() override;
 
-  void begin_tx();
+  bool begin_tx();
+  bool wait_tx(std::function<void()> &&resume);
   void end_tx();
+  void dump_stats();
+  void afc_update(uint8_t key);
+  // safe to call from interrupts
+  __attribute__((always_inline)) bool is_transmitting() const { return this->transmitting_; }
 };
 
 template<typename... Ts> class BeginTxAction : public Action<Ts...>, public Parented<CC1101> {
  public:
-  void play(Ts... x) override { this->parent_->begin_tx(); }
+  // the rest of the chain only runs when the radio got its TX window
+  void play_complex(Ts... x) override {
+    this->num_running_++;
+    this->try_begin_(x...);
+  }
+
+ protected:
+  void play(Ts... x) override {}
+
+  void try_begin_(Ts... x) {
+    if (this->parent_->begin_tx()) {
+      this->play_next_(x...);
+      return;
+    }
+    // another radio holds the TX window, the chain continues once it is released
+    if (this->parent_->wait_tx([this, x...]() {
+          if (this->num_running_ > 0) {
+            this->try_begin_(x...);
+          }
+        })) {
+      return;
+    }
+    this->num_running_--;
+  }
 };
 
 template<typename... Ts> class EndTxAction : public Action<Ts...>, public Parented<CC1101> {
@@ -107,10 +309,23 @@ template<typename... Ts> class EndTxAction : public Action<Ts...>, public Parent
   void play(Ts... x) override { this->parent_->end_tx(); }
 };
 
+template<typename... Ts> class DumpStatsAction : public Action<Ts...>, public Parented<CC1101> {
+ public:
+  void play(Ts... x) override { this->parent_->dump_stats(); }
+};
+
+template<typename... Ts> class AFCUpdateAction : public Action<Ts...>, public Parented<CC1101> {
+ public:
+  TEMPLATABLE_VALUE(uint8_t, key)
+
+  void play(Ts... x) override { this->parent_->afc_update(this->key_.value(x...)); }
+};
+
 template<typename... Ts> class CC1101RawAction : public remote_base::RCSwitchRawAction<Ts...>, public Parented<CC1101> {
  protected:
   void play(Ts... x) override {
-    this->parent_->begin_tx();
+    if (!this->parent_->begin_tx())
+      return;
     remote_base::RCSwitchRawAction<Ts...>::play(x...);
     this->parent_->end_tx();
   }
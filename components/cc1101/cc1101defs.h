@@ -102,15 +102,19 @@ static constexpr uint32_t CC1101_READ_SINGLE = 0x80;      // read single
 static constexpr uint32_t CC1101_READ_BURST = 0xC0;       // read burst
 static constexpr uint32_t CC1101_BYTES_IN_RXFIFO = 0x7F;  // byte number in RXfifo
 
+static constexpr uint32_t CC1101_FXOSC = 26000000;  // crystal frequency, Hz
+
 static constexpr uint32_t CC1101_MARCSTATE_IDLE = 0x01;
 
 static constexpr uint32_t CC1101_MARCSTATE_RX = 0x0D;
 static constexpr uint32_t CC1101_MARCSTATE_RX_END = 0x0E;
 static constexpr uint32_t CC1101_MARCSTATE_TXRX_SWITCH = 0x0F;
+static constexpr uint32_t CC1101_MARCSTATE_RXFIFO_OVERFLOW = 0x11;
 
 static constexpr uint32_t CC1101_MARCSTATE_TX = 0x13;
 static constexpr uint32_t CC1101_MARCSTATE_TX_END = 0x14;
 static constexpr uint32_t CC1101_MARCSTATE_RXTX_SWITCH = 0x15;
+static constexpr uint32_t CC1101_MARCSTATE_TXFIFO_UNDERFLOW = 0x16;
 
 }  // namespace cc1101
 }  // namespace esphome
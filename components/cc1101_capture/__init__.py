@@ -0,0 +1,93 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome import pins
+from esphome.components import sensor
+from esphome.components import remote_base
+from esphome.components import cc1101
+from esphome.const import (
+    CONF_ID,
+    CONF_PIN,
+    CONF_DUMP,
+    CONF_FILTER,
+    CONF_IDLE,
+    CONF_BUFFER_SIZE,
+    UNIT_EMPTY,
+    UNIT_MICROSECOND,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+)
+
+DEPENDENCIES = ["cc1101"]
+AUTO_LOAD = ["sensor", "remote_base"]
+
+CONF_OVERFLOWS = "overflows"
+CONF_LATENCY = "latency"
+
+ns = cg.esphome_ns.namespace("cc1101_capture")
+
+CC1101Capture = ns.class_(
+    "CC1101Capture", remote_base.RemoteReceiverBase, cg.PollingComponent
+)
+
+
+def validate_buffer_size(value):
+    value = cv.int_range(min=64, max=32768)(value)
+    if value & (value - 1):
+        raise cv.Invalid("buffer_size must be a power of two")
+    return value
+
+
+CONFIG_SCHEMA = remote_base.validate_triggers(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(CC1101Capture),
+            cv.GenerateID(cc1101.CONF_CC1101_ID): cv.use_id(cc1101.CC1101),
+            # GDO2, serial data output in asynchronous mode
+            cv.Required(CONF_PIN): pins.internal_gpio_input_pin_schema,
+            cv.Optional(CONF_DUMP, default=[]): remote_base.validate_dumpers,
+            cv.Optional(CONF_FILTER, default="50us"): cv.positive_time_period_microseconds,
+            cv.Optional(CONF_IDLE, default="4ms"): cv.positive_time_period_microseconds,
+            # edges, allocated once
+            cv.Optional(CONF_BUFFER_SIZE, default=1024): validate_buffer_size,
+            cv.Optional(CONF_OVERFLOWS): sensor.sensor_schema(
+                unit_of_measurement=UNIT_EMPTY,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_LATENCY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MICROSECOND,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+        }
+    ).extend(cv.polling_component_schema("60s"))
+)
+
+
+async def to_code(config):
+    pin = await cg.gpio_pin_expression(config[CONF_PIN])
+    var = cg.new_Pvariable(config[CONF_ID], pin)
+    await cg.register_component(var, config)
+
+    parent = await cg.get_variable(config[cc1101.CONF_CC1101_ID])
+    cg.add(var.set_parent(parent))
+    cg.add(var.set_filter_us(config[CONF_FILTER]))
+    cg.add(var.set_idle_us(config[CONF_IDLE]))
+    cg.add(var.set_buffer_size(config[CONF_BUFFER_SIZE]))
+
+    dumpers = await remote_base.build_dumpers(config[CONF_DUMP])
+    for dumper in dumpers:
+        cg.add(var.register_dumper(dumper))
+    triggers = await remote_base.build_triggers(config)
+    for trigger in triggers:
+        cg.add(var.register_listener(trigger))
+
+    if CONF_OVERFLOWS in config:
+        sens = await sensor.new_sensor(config[CONF_OVERFLOWS])
+        cg.add(var.set_overflows_sensor(sens))
+    if CONF_LATENCY in config:
+        sens = await sensor.new_sensor(config[CONF_LATENCY])
+        cg.add(var.set_latency_sensor(sens))
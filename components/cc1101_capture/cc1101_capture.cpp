@@ -0,0 +1,214 @@
+#include "cc1101_capture.h"
+#include "esphome/core/log.h"
+
+#ifdef USE_ESP32
+#include <soc/soc_caps.h>
+#if SOC_MCPWM_SUPPORTED
+#include <driver/mcpwm_cap.h>
+#define CC1101_CAPTURE_MCPWM
+#endif
+#endif
+
+namespace esphome {
+namespace cc1101_capture {
+
+static const char *const TAG = "cc1101_capture";
+
+#ifdef CC1101_CAPTURE_MCPWM
+static bool IRAM_ATTR mcpwm_isr(mcpwm_cap_channel_handle_t channel, const mcpwm_capture_event_data_t *data,
+                                void *arg) {
+  static_cast<CC1101Capture *>(arg)->store_edge(data->cap_value, data->cap_edge == MCPWM_CAP_EDGE_POS);
+  return false;
+}
+#endif
+
+// micros() doubled so the level bit doesn't cost resolution
+void IRAM_ATTR CC1101Capture::gpio_isr_(CC1101Capture *arg) {
+  arg->store_edge(micros() << 1, arg->isr_pin_.digital_read());
+}
+
+void IRAM_ATTR CC1101Capture::store_edge(uint32_t ticks, bool level) {
+  CC1101Edge edge{(ticks & ~1u) | level, micros(), this->lost_, this->parent_->is_transmitting()};
+  if (this->buffer_.push(edge)) {
+    this->lost_ = false;
+  } else {
+    this->lost_ = true;
+    // the only writer, no read-modify-write needed
+    this->overflows_.store(this->overflows_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+}
+
+void CC1101Capture::setup() {
+  this->buffer_.init(this->buffer_size_);
+  this->temp_.reserve(this->buffer_size_);
+  this->pin_->setup();
+
+#ifdef CC1101_CAPTURE_MCPWM
+  mcpwm_cap_timer_handle_t timer = nullptr;
+  mcpwm_cap_channel_handle_t channel = nullptr;
+  mcpwm_capture_timer_config_t timer_config{};
+  timer_config.group_id = 0;
+  timer_config.clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT;
+  mcpwm_capture_channel_config_t channel_config{};
+  channel_config.gpio_num = this->pin_->get_pin();
+  channel_config.prescale = 1;
+  channel_config.flags.pos_edge = true;
+  channel_config.flags.neg_edge = true;
+  mcpwm_capture_event_callbacks_t callbacks{};
+  callbacks.on_cap = mcpwm_isr;
+  uint32_t resolution = 0;
+
+  bool channel_enabled = false;
+  bool timer_enabled = false;
+  bool timer_started = false;
+
+  esp_err_t err = mcpwm_new_capture_timer(&timer_config, &timer);
+  if (err == ESP_OK)
+    err = mcpwm_new_capture_channel(timer, &channel_config, &channel);
+  if (err == ESP_OK)
+    err = mcpwm_capture_channel_register_event_callbacks(channel, &callbacks, this);
+  if (err == ESP_OK)
+    channel_enabled = (err = mcpwm_capture_channel_enable(channel)) == ESP_OK;
+  if (err == ESP_OK)
+    timer_enabled = (err = mcpwm_capture_timer_enable(timer)) == ESP_OK;
+  if (err == ESP_OK)
+    err = mcpwm_capture_timer_get_resolution(timer, &resolution);
+  if (err == ESP_OK && resolution < 1000000)
+    err = ESP_ERR_NOT_SUPPORTED;
+  if (err == ESP_OK)
+    timer_started = (err = mcpwm_capture_timer_start(timer)) == ESP_OK;
+  if (err == ESP_OK) {
+    this->hardware_ = true;
+    this->ticks_per_us_ = resolution / 1000000;
+    return;
+  }
+  ESP_LOGW(TAG, "MCPWM capture not available (%s), falling back to a GPIO interrupt", esp_err_to_name(err));
+
+  // the GPIO matrix and the interrupt are released with the channel, in reverse order of creation
+  if (timer_started)
+    mcpwm_capture_timer_stop(timer);
+  if (timer_enabled)
+    mcpwm_capture_timer_disable(timer);
+  if (channel_enabled)
+    mcpwm_capture_channel_disable(channel);
+  if (channel != nullptr)
+    mcpwm_del_capture_channel(channel);
+  if (timer != nullptr)
+    mcpwm_del_capture_timer(timer);
+#endif
+
+  this->isr_pin_ = this->pin_->to_isr();
+  this->pin_->attach_interrupt(CC1101Capture::gpio_isr_, this, gpio::INTERRUPT_ANY_EDGE);
+}
+
+void CC1101Capture::loop() {
+  uint32_t overflows = this->overflows_.load(std::memory_order_relaxed);
+  if (overflows != this->last_overflows_) {
+    // the next stored edge is marked lost, that discards the burst the gap is in
+    ESP_LOGD(TAG, "Capture buffer overflow, %u edges dropped", (unsigned) (overflows - this->last_overflows_));
+    this->last_overflows_ = overflows;
+  }
+
+  CC1101Edge edge;
+  while (this->buffer_.pop(edge)) {
+    if (edge.tx) {
+      // our own transmission
+      this->reset_burst_();
+      continue;
+    }
+    if (edge.lost) {
+      // edges are missing right before this one, the burst is incomplete
+      this->discard_ = true;
+    }
+    if (!this->has_previous_) {
+      this->previous_ = edge;
+      this->has_previous_ = true;
+      this->last_duration_ = 0;
+      continue;
+    }
+    uint32_t us = ((edge.ticks & ~1u) - (this->previous_.ticks & ~1u)) / this->ticks_per_us_;
+    if (us > this->idle_us_) {
+      // the burst ended before this edge, the loop fell behind
+      this->dispatch_(this->previous_.us);
+      this->discard_ = edge.lost;
+      this->previous_ = edge;
+      this->last_duration_ = 0;
+      continue;
+    }
+    if (us < this->filter_us_) {
+      // glitch, dropped together with the edge that started it
+      if (this->last_duration_ != 0) {
+        this->temp_.back() -= this->last_duration_;
+        if (this->temp_.back() == 0) {
+          this->temp_.pop_back();
+        }
+        this->previous_ = this->before_previous_;
+        this->last_duration_ = 0;
+      } else if (this->temp_.empty()) {
+        this->has_previous_ = false;
+      }
+      continue;
+    }
+    // positive while high, same level intervals left around a glitch are joined
+    int32_t duration = (this->previous_.ticks & 1) ? us : -static_cast<int32_t>(us);
+    if (!this->temp_.empty() && (this->temp_.back() > 0) == (duration > 0)) {
+      this->temp_.back() += duration;
+    } else {
+      this->temp_.push_back(duration);
+    }
+    this->before_previous_ = this->previous_;
+    this->previous_ = edge;
+    this->last_duration_ = duration;
+  }
+
+  // no edge for idle, the burst is complete
+  if (this->has_previous_ && micros() - this->previous_.us > this->idle_us_) {
+    this->dispatch_(this->previous_.us);
+    this->has_previous_ = false;
+  }
+}
+
+void CC1101Capture::dispatch_(uint32_t last_edge_us) {
+  if (this->discard_) {
+    this->discard_ = false;
+  } else if (!this->temp_.empty()) {
+    uint32_t latency = micros() - last_edge_us;
+    if (latency > this->max_latency_) {
+      this->max_latency_ = latency;
+    }
+    ESP_LOGV(TAG, "Burst of %u intervals, %u us after the last edge", (unsigned) this->temp_.size(),
+             (unsigned) latency);
+    this->call_listeners_dumpers_();
+  }
+  this->temp_.clear();
+}
+
+void CC1101Capture::reset_burst_() {
+  this->temp_.clear();
+  this->has_previous_ = false;
+  this->discard_ = false;
+}
+
+void CC1101Capture::update() {
+  if (this->overflows_sensor_ != nullptr) {
+    this->overflows_sensor_->publish_state(this->last_overflows_);
+  }
+  if (this->latency_sensor_ != nullptr) {
+    this->latency_sensor_->publish_state(this->max_latency_);
+  }
+  this->max_latency_ = 0;
+}
+
+void CC1101Capture::dump_config() {
+  ESP_LOGCONFIG(TAG, "CC1101 Capture:");
+  LOG_PIN("  Pin: ", this->pin_);
+  ESP_LOGCONFIG(TAG, "  Timestamps: %s", this->hardware_ ? "MCPWM capture" : "GPIO interrupt");
+  ESP_LOGCONFIG(TAG, "  Buffer Size: %u edges", (unsigned) this->buffer_size_);
+  ESP_LOGCONFIG(TAG, "  Filter: %u us", (unsigned) this->filter_us_);
+  ESP_LOGCONFIG(TAG, "  Idle: %u us", (unsigned) this->idle_us_);
+  LOG_SENSOR("  ", "Overflows", this->overflows_sensor_);
+  LOG_SENSOR("  ", "Latency", this->latency_sensor_);
+}
+
+}  // namespace cc1101_capture
+}  // namespace esphome
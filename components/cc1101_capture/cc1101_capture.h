@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/remote_base/remote_base.h"
+#include "esphome/components/cc1101/cc1101.h"
+
+namespace esphome {
+namespace cc1101_capture {
+
+struct CC1101Edge {
+  uint32_t ticks;  // capture timer, the lowest bit is the level after the edge
+  uint32_t us;     // micros() when the edge was stored
+  bool lost;       // edges were dropped right before this one
+  bool tx;         // stored while the radio was transmitting
+};
+
+// Single producer (the capture interrupt), single consumer (loop). Allocated once in setup.
+class CC1101EdgeBuffer {
+ public:
+  void init(size_t capacity) {
+    this->edges_ = std::make_unique<CC1101Edge[]>(capacity);
+    this->mask_ = capacity - 1;
+  }
+
+  // called from the capture interrupt, inlined so it runs from IRAM with store_edge
+  __attribute__((always_inline)) bool push(const CC1101Edge &edge) {
+    uint32_t head = this->head_.load(std::memory_order_relaxed);
+    if (head - this->tail_.load(std::memory_order_acquire) > this->mask_) {
+      return false;
+    }
+    this->edges_[head & this->mask_] = edge;
+    this->head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(CC1101Edge &edge) {
+    uint32_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (tail == this->head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    edge = this->edges_[tail & this->mask_];
+    this->tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+ protected:
+  std::unique_ptr<CC1101Edge[]> edges_;
+  uint32_t mask_{0};  // capacity is a power of two
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+};
+
+class CC1101Capture : public remote_base::RemoteReceiverBase, public PollingComponent {
+ public:
+  explicit CC1101Capture(InternalGPIOPin *pin) : RemoteReceiverBase(pin) {}
+
+  float get_setup_priority() const override { return setup_priority::DATA; }
+  void setup() override;
+  void loop() override;
+  void update() override;
+  void dump_config() override;
+
+  void set_parent(cc1101::CC1101 *parent) { this->parent_ = parent; }
+  void set_buffer_size(uint32_t buffer_size) { this->buffer_size_ = buffer_size; }
+  void set_filter_us(uint32_t filter_us) { this->filter_us_ = filter_us; }
+  void set_idle_us(uint32_t idle_us) { this->idle_us_ = idle_us; }
+  void set_overflows_sensor(sensor::Sensor *overflows_sensor) { this->overflows_sensor_ = overflows_sensor; }
+  void set_latency_sensor(sensor::Sensor *latency_sensor) { this->latency_sensor_ = latency_sensor; }
+
+  // called from the capture interrupt
+  void store_edge(uint32_t ticks, bool level);
+
+ protected:
+  static void gpio_isr_(CC1101Capture *arg);
+  void dispatch_(uint32_t last_edge_us);
+  void reset_burst_();
+
+  cc1101::CC1101 *parent_{nullptr};
+  uint32_t buffer_size_{1024};
+  uint32_t filter_us_{50};
+  uint32_t idle_us_{4000};
+  sensor::Sensor *overflows_sensor_{nullptr};
+  sensor::Sensor *latency_sensor_{nullptr};
+
+  CC1101EdgeBuffer buffer_;
+  ISRInternalGPIOPin isr_pin_;
+  bool hardware_{false};     // MCPWM capture, otherwise a GPIO interrupt with micros()
+  uint32_t ticks_per_us_{2};
+  std::atomic<uint32_t> overflows_{0};  // edges dropped because the buffer was full
+  bool lost_{false};                     // only used by the interrupt
+
+  // burst being collected in temp_
+  bool has_previous_{false};
+  bool discard_{false};  // edges of the burst were lost
+  CC1101Edge previous_{};
+  CC1101Edge before_previous_{};
+  int32_t last_duration_{0};  // interval ending at previous_, 0 if it can't be undone
+  uint32_t last_overflows_{0};
+  uint32_t max_latency_{0};  // us, since the last update
+};
+
+}  // namespace cc1101_capture
+}  // namespace esphome
@@ -0,0 +1,51 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.components import cc1101
+from esphome.const import (
+    CONF_ID,
+    UNIT_PERCENT,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+)
+
+DEPENDENCIES = ["cc1101"]
+AUTO_LOAD = ["sensor"]
+
+CONF_RADIOS = "radios"
+CONF_BUS_UTILIZATION = "bus_utilization"
+
+ns = cg.esphome_ns.namespace("cc1101_manager")
+
+CC1101Manager = ns.class_("CC1101Manager", cg.PollingComponent)
+
+RADIO_SCHEMA = cv.Schema(
+    {
+        cv.Required(cc1101.CONF_CC1101_ID): cv.use_id(cc1101.CC1101),
+        cv.Optional(CONF_BUS_UTILIZATION): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=2,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(CC1101Manager),
+        cv.Required(CONF_RADIOS): cv.All(cv.ensure_list(RADIO_SCHEMA), cv.Length(min=1)),
+    }
+).extend(cv.polling_component_schema("60s"))
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+
+    for radio in config[CONF_RADIOS]:
+        parent = await cg.get_variable(radio[cc1101.CONF_CC1101_ID])
+        bus_utilization = cg.nullptr
+        if CONF_BUS_UTILIZATION in radio:
+            bus_utilization = await sensor.new_sensor(radio[CONF_BUS_UTILIZATION])
+        cg.add(var.add_radio(parent, bus_utilization))
@@ -0,0 +1,113 @@
+#include "cc1101_manager.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace cc1101_manager {
+
+static const char *const TAG = "cc1101_manager";
+
+// refused TX requests beyond this are dropped
+static const size_t MAX_WAITING = 8;
+
+void CC1101Manager::add_radio(cc1101::CC1101 *radio, sensor::Sensor *bus_utilization) {
+  this->radios_.push_back({radio, bus_utilization, 0, 0, 0});
+  radio->set_bus_listener(this);
+}
+
+void CC1101Manager::setup() { this->last_update_ = micros(); }
+
+void CC1101Manager::update() {
+  uint32_t now = micros();
+  uint32_t elapsed = now - this->last_update_;
+  this->last_update_ = now;
+
+  if (elapsed == 0)
+    return;
+
+  for (size_t i = 0; i < this->radios_.size(); i++) {
+    Radio &r = this->radios_[i];
+    float utilization = r.bus_time * 100.0f / elapsed;
+    ESP_LOGD(TAG, "Radio %u: bus %.2f%%, tx %u ms, tx refused %u", (unsigned) i, utilization, (unsigned) r.tx_time,
+             (unsigned) r.tx_refused);
+    if (r.bus_utilization != nullptr) {
+      r.bus_utilization->publish_state(utilization);
+    }
+    r.bus_time = 0;
+    r.tx_time = 0;
+  }
+}
+
+void CC1101Manager::dump_config() {
+  ESP_LOGCONFIG(TAG, "CC1101 Manager:");
+  ESP_LOGCONFIG(TAG, "  Radios: %u", (unsigned) this->radios_.size());
+  for (auto &r : this->radios_) {
+    LOG_SENSOR("  ", "Bus utilization", r.bus_utilization);
+  }
+  LOG_UPDATE_INTERVAL(this);
+}
+
+CC1101Manager::Radio *CC1101Manager::find_radio_(cc1101::CC1101 *radio) {
+  for (auto &r : this->radios_) {
+    if (r.radio == radio)
+      return &r;
+  }
+  return nullptr;
+}
+
+void CC1101Manager::on_bus_transaction(cc1101::CC1101 *radio, uint32_t duration_us) {
+  Radio *r = this->find_radio_(radio);
+  if (r != nullptr) {
+    r->bus_time += duration_us;
+  }
+}
+
+bool CC1101Manager::on_tx_request(cc1101::CC1101 *radio) {
+  // only one radio may hold a TX window, the others stay in RX so their receivers keep draining
+  if (this->tx_owner_ != nullptr && this->tx_owner_ != radio) {
+    Radio *r = this->find_radio_(radio);
+    if (r != nullptr) {
+      r->tx_refused++;
+    }
+    return false;
+  }
+  if (this->tx_owner_ == nullptr) {
+    this->tx_owner_ = radio;
+    this->tx_start_ = millis();
+  }
+  return true;
+}
+
+void CC1101Manager::on_tx_release(cc1101::CC1101 *radio) {
+  if (this->tx_owner_ != radio)
+    return;
+  Radio *r = this->find_radio_(radio);
+  if (r != nullptr) {
+    r->tx_time += millis() - this->tx_start_;
+  }
+  this->tx_owner_ = nullptr;
+  if (!this->waiting_.empty()) {
+    // not from inside end_tx, the resumed chain may transmit right away
+    this->defer([this]() { this->resume_waiting_(); });
+  }
+}
+
+bool CC1101Manager::on_tx_wait(cc1101::CC1101 *radio, std::function<void()> &&resume) {
+  if (this->waiting_.size() >= MAX_WAITING) {
+    ESP_LOGW(TAG, "Too many radios waiting for TX, frame dropped");
+    return false;
+  }
+  this->waiting_.push_back(std::move(resume));
+  return true;
+}
+
+void CC1101Manager::resume_waiting_() {
+  // a resumed chain that was stopped or finished its TX window right away leaves the window free for the next one
+  while (this->tx_owner_ == nullptr && !this->waiting_.empty()) {
+    std::function<void()> resume = std::move(this->waiting_.front());
+    this->waiting_.pop_front();
+    resume();
+  }
+}
+
+}  // namespace cc1101_manager
+}  // namespace esphome
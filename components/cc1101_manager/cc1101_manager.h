@@ -0,0 +1,47 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <vector>
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/cc1101/cc1101.h"
+
+namespace esphome {
+namespace cc1101_manager {
+
+class CC1101Manager : public PollingComponent, public cc1101::CC1101BusListener {
+ public:
+  float get_setup_priority() const override { return setup_priority::HARDWARE; }
+  void setup() override;
+  void update() override;
+  void dump_config() override;
+
+  void add_radio(cc1101::CC1101 *radio, sensor::Sensor *bus_utilization);
+
+  void on_bus_transaction(cc1101::CC1101 *radio, uint32_t duration_us) override;
+  bool on_tx_request(cc1101::CC1101 *radio) override;
+  void on_tx_release(cc1101::CC1101 *radio) override;
+  bool on_tx_wait(cc1101::CC1101 *radio, std::function<void()> &&resume) override;
+
+ protected:
+  struct Radio {
+    cc1101::CC1101 *radio;
+    sensor::Sensor *bus_utilization;
+    uint32_t bus_time;    // us spent on the bus since the last update
+    uint32_t tx_time;     // ms spent transmitting since the last update
+    uint32_t tx_refused;  // TX requests refused because another radio was transmitting
+  };
+
+  Radio *find_radio_(cc1101::CC1101 *radio);
+  void resume_waiting_();
+
+  std::vector<Radio> radios_;
+  cc1101::CC1101 *tx_owner_{nullptr};
+  uint32_t tx_start_{0};
+  std::deque<std::function<void()>> waiting_;  // refused TX requests, resumed in order
+  uint32_t last_update_{0};
+};
+
+}  // namespace cc1101_manager
+}  // namespace esphome
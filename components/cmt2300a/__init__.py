@@ -0,0 +1 @@
+CODEOWNERS = ["@swoboda1337"]
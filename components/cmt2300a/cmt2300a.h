@@ -16,6 +16,20 @@
  *   p2 = d3 ⊕ d1 ⊕ d0
  *   p1 = d3 ⊕ d2 ⊕ d1
  *   p0 = d2 ⊕ d1 ⊕ d0
+ *
+ * Optionally a CRC-8 (poly 0x07) or CRC-16/CCITT (poly 0x1021, init 0xFFFF) is
+ * appended to the data before encoding and verified while decoding. The CRC
+ * bytes are counted in the size byte.
+ *
+ * The codec is a template over the codeword (parity equations, bit order and an
+ * optional overall parity bit for Hamming(8,4) SECDED) and the header policy.
+ * Encode and decode tables are generated at compile time for each variant.
+ * Each block can also be repeated three times, the decoder takes the bitwise
+ * majority before correcting. CMT2300A is the default variant described above.
+ *
+ * Optionally the bytes (size byte, data and CRC) are XORed with a whitening
+ * sequence, PN9 or another LFSR, in the same loop that packs or unpacks the
+ * blocks. The CRC is computed over the data before whitening.
  */
 
 #ifndef CMT2300A_H
@@ -25,247 +39,745 @@
 #include <cstdint>
 #include <vector>
 #include <limits>
+#include <array>
+#include <type_traits>
+
+namespace cmt2300a_detail {
+
+struct CRC8Table {
+  uint8_t table[256];
+};
+
+struct CRC16Table {
+  uint16_t table[256];
+};
+
+constexpr CRC8Table make_crc8_table() {
+  CRC8Table t{};
+  for (int i = 0; i < 256; i++) {
+    uint8_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    t.table[i] = crc;
+  }
+  return t;
+}
+
+constexpr CRC16Table make_crc16_table() {
+  CRC16Table t{};
+  for (int i = 0; i < 256; i++) {
+    uint16_t crc = i << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    t.table[i] = crc;
+  }
+  return t;
+}
+
+static constexpr CRC8Table CRC8_TABLE = make_crc8_table();
+static constexpr CRC16Table CRC16_TABLE = make_crc16_table();
+
+template<std::size_t N> constexpr bool equal(const std::array<uint8_t, N> &a, const std::array<uint8_t, N> &b) {
+  for (std::size_t i = 0; i < N; i++) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr uint8_t parity4(uint8_t value) { return ((value >> 3) ^ (value >> 2) ^ (value >> 1) ^ value) & 1; }
+
+constexpr uint8_t parity8(uint8_t value) { return parity4(value) ^ parity4(value >> 4); }
+
+/**
+ * @brief Encode and decode tables for a Hamming code over a nibble
+ *
+ * Decode entries hold the data nibble in bits [3:0] and the CORRECTED or
+ * UNCORRECTABLE flag.
+ */
+template<int BITS> struct HammingTables {
+  uint8_t encode[16];
+  uint8_t decode[1 << BITS];
+  // false if two codewords are closer than 3 bits
+  bool valid;
+};
+
+}  // namespace cmt2300a_detail
+
+/**
+ * @brief Whitening sequence XORed with each byte, it repeats after 256 bytes
+ */
+struct CMT2300AWhitening {
+  uint8_t sequence[256];
+};
+
+/**
+ * @brief Whitening sequence of a Fibonacci LFSR
+ *
+ * Each byte is the low 8 bits of the register, which is then shifted right 8
+ * times with the XOR of the tapped bits fed into the top bit.
+ *
+ * @param width Register width in bits (8-16)
+ * @param taps Mask of the register bits XORed into the feedback
+ * @param seed Initial register value
+ */
+constexpr CMT2300AWhitening make_cmt2300a_whitening(int width, uint16_t taps, uint16_t seed) {
+  CMT2300AWhitening w{};
+  uint16_t key = seed;
+  for (int i = 0; i < 256; i++) {
+    w.sequence[i] = key & 0xFF;
+    for (int bit = 0; bit < 8; bit++) {
+      uint16_t feedback = 0;
+      for (int tap = 0; tap < width; tap++) {
+        if ((taps >> tap) & 1) {
+          feedback ^= (key >> tap) & 1;
+        }
+      }
+      key = (key >> 1) | (feedback << (width - 1));
+    }
+  }
+  return w;
+}
+
+/**
+ * @brief No whitening, XOR with zero
+ *
+ * Inline so every translation unit shares one object, the codec compares whitening pointers.
+ */
+inline constexpr CMT2300AWhitening CMT2300A_NO_WHITENING{};
+
+/**
+ * @brief PN9, x⁹ + x⁵ + 1 seeded with all ones
+ */
+inline constexpr CMT2300AWhitening CMT2300A_PN9 = make_cmt2300a_whitening(9, (1 << 5) | (1 << 0), 0x1FF);
+
+static_assert(CMT2300A_PN9.sequence[0] == 0xFF && CMT2300A_PN9.sequence[1] == 0xE1 &&
+                  CMT2300A_PN9.sequence[2] == 0x1D && CMT2300A_PN9.sequence[3] == 0x9A,
+              "PN9 must match the usual sequence");
+
+/**
+ * @brief Bit order of a codeword
+ */
+enum class CMT2300ALayout : uint8_t {
+  DATA_FIRST,    // [d3 d2 d1 d0 | p2 p1 p0]
+  PARITY_FIRST,  // [p2 p1 p0 | d3 d2 d1 d0]
+};
+
+/**
+ * @brief What precedes the data
+ */
+enum class CMT2300AHeader : uint8_t {
+  LENGTH,  // one encoded byte holding the size of the data
+  NONE,    // no header, the data runs to the end of the input
+};
+
+/**
+ * @brief Hamming code over one nibble
+ *
+ * P2, P1 and P0 are masks of the data bits [d3 d2 d1 d0] feeding each parity
+ * bit. SECDED appends an overall parity bit after the codeword, double bit
+ * errors are then detected instead of miscorrected.
+ */
+template<uint8_t P2 = 0b1011, uint8_t P1 = 0b1110, uint8_t P0 = 0b0111,
+         CMT2300ALayout LAYOUT = CMT2300ALayout::DATA_FIRST, bool SECDED = false>
+struct CMT2300AHamming {
+  static constexpr int BITS = SECDED ? 8 : 7;
+  static constexpr uint8_t CORRECTED = 0x10;
+  static constexpr uint8_t UNCORRECTABLE = 0x20;
+
+  static constexpr uint8_t codeword(uint8_t nibble) {
+    uint8_t parity = (cmt2300a_detail::parity4(nibble & P2) << 2) | (cmt2300a_detail::parity4(nibble & P1) << 1) |
+                     cmt2300a_detail::parity4(nibble & P0);
+    uint8_t word = LAYOUT == CMT2300ALayout::DATA_FIRST ? (nibble << 3) | parity : (parity << 4) | nibble;
+    return SECDED ? (word << 1) | cmt2300a_detail::parity8(word) : word;
+  }
+
+  static constexpr uint8_t data_bits(uint8_t word) {
+    if (SECDED) {
+      word >>= 1;
+    }
+    return LAYOUT == CMT2300ALayout::DATA_FIRST ? (word >> 3) & 0x0F : word & 0x0F;
+  }
+
+  static constexpr cmt2300a_detail::HammingTables<BITS> make_tables() {
+    cmt2300a_detail::HammingTables<BITS> t{};
+    t.valid = true;
+    // anything further than one bit from a codeword can't be corrected
+    for (int word = 0; word < (1 << BITS); word++) {
+      t.decode[word] = data_bits(word) | UNCORRECTABLE;
+    }
+    for (int nibble = 0; nibble < 16; nibble++) {
+      uint8_t word = codeword(nibble);
+      t.encode[nibble] = word;
+      if (t.decode[word] != (data_bits(word) | UNCORRECTABLE)) {
+        t.valid = false;
+      }
+      t.decode[word] = nibble;
+    }
+    for (int nibble = 0; nibble < 16; nibble++) {
+      for (int bit = 0; bit < BITS; bit++) {
+        uint8_t word = t.encode[nibble] ^ (1 << bit);
+        if ((t.decode[word] & UNCORRECTABLE) == 0) {
+          t.valid = false;
+        }
+        t.decode[word] = nibble | CORRECTED;
+      }
+    }
+    return t;
+  }
+
+  static constexpr cmt2300a_detail::HammingTables<BITS> TABLES = make_tables();
+
+  static constexpr int CHECKS = SECDED ? 4 : 3;
+
+  /**
+   * @brief Parity check i as a mask of codeword bits, the bits of a codeword XOR to zero
+   */
+  static constexpr uint8_t check(int i) {
+    if (i == 3) {
+      return 0xFF;
+    }
+    uint8_t data = i == 2 ? P2 : i == 1 ? P1 : P0;
+    uint8_t mask = LAYOUT == CMT2300ALayout::DATA_FIRST ? (data << 3) | (1 << i) : (1 << (4 + i)) | data;
+    return SECDED ? mask << 1 : mask;
+  }
 
-class CMT2300A {
- public:
   /**
-   * @brief Encode a single 4-bit nibble into a 7-bit Hamming codeword
+   * @brief Syndrome check of a codeword at every bit position at once
    *
-   * @param nibble 4-bit data value (0x0-0xF)
-   * @return 7-bit Hamming codeword
+   * Bit 63 is the first bit of the stream. Bit 63 - p of the result is set if
+   * the codeword starting at stream bit p has a zero syndrome.
+   */
+  static inline uint64_t syndrome_zero(uint64_t stream) {
+    uint64_t syndrome = 0;
+    for (int i = 0; i < CHECKS; i++) {
+      uint64_t sum = 0;
+      for (int bit = 0; bit < BITS; bit++) {
+        if ((check(i) >> bit) & 1) {
+          sum ^= stream << (BITS - 1 - bit);
+        }
+      }
+      syndrome |= sum;
+    }
+    return ~syndrome;
+  }
+};
+
+/**
+ * @brief Parts of the codec shared by all variants
+ */
+class CMT2300ABase {
+ public:
+  /**
+   * @brief Integrity check appended to the data
    */
-  static inline uint8_t encode_nibble(uint8_t nibble) {
-    // Mask to 4 bits
-    nibble &= 0x0F;
+  enum CRCMode : uint8_t {
+    CRC_NONE = 0,
+    CRC_8 = 1,
+    CRC_16 = 2,
+  };
 
-    // Compute parity bits
-    uint8_t parity = compute_parity(nibble);
+  /**
+   * @brief Number of CRC bytes appended for a mode
+   */
+  static constexpr uint8_t crc_size(CRCMode crc) { return static_cast<uint8_t>(crc); }
 
-    // Create systematic codeword: [d3 d2 d1 d0 | p2 p1 p0]
-    uint8_t codeword = (nibble << 3) | parity;
+  /**
+   * @brief Initial CRC register value for a mode
+   */
+  static constexpr uint16_t crc_init(CRCMode crc) { return crc == CRC_16 ? 0xFFFF : 0x0000; }
 
-    return codeword;
+  /**
+   * @brief Update a CRC register with one byte, table driven
+   */
+  static constexpr uint16_t crc_update(CRCMode crc, uint16_t value, uint8_t byte) {
+    if (crc == CRC_16) {
+      return (value << 8) ^ cmt2300a_detail::CRC16_TABLE.table[((value >> 8) ^ byte) & 0xFF];
+    }
+    if (crc == CRC_8) {
+      return cmt2300a_detail::CRC8_TABLE.table[(value ^ byte) & 0xFF];
+    }
+    return value;
   }
+};
+
+template<typename CODE = CMT2300AHamming<>, CMT2300AHeader HEADER = CMT2300AHeader::LENGTH, int REPEAT = 1>
+class BasicCMT2300A : public CMT2300ABase {
+  static_assert(CODE::TABLES.valid, "parity equations must give a minimum distance of 3");
+  static_assert(REPEAT == 1 || REPEAT == 3, "blocks are sent once or three times");
 
+ public:
   /**
-   * @brief Encode a stream of bytes with FEC protection
-   *
-   * Each byte is split into two nibbles, each encoded as a 7-bit codeword,
-   * and packed into a continuous 14-bit block stream. The size of the data
-   * is prepended as the first encoded byte to allow automatic size detection
-   * during decoding.
+   * @brief Bits per encoded byte, two codewords
+   */
+  static constexpr int BLOCK_BITS = 2 * CODE::BITS;
+
+  /**
+   * @brief Encoded bits per data byte, including repeats
+   */
+  static constexpr int STEP_BITS = REPEAT * BLOCK_BITS;
+
+  /**
+   * @brief Codewords scored per candidate offset by find_sync, as many as fit a 64-bit word after 7 bits of offset
+   */
+  static constexpr int SYNC_CODEWORDS = (64 - 7) / CODE::BITS;
+
+  /**
+   * @brief Offsets decode_sync may try when the CRC fails, every offset of a 64 bit window
+   */
+  static constexpr std::size_t SYNC_CANDIDATES = 64;
+
+  /**
+   * @brief Encode a single 4-bit nibble into a Hamming codeword
    *
-   * @param data Input data bytes to encode (max 255 bytes)
-   * @param encoded Output vector to receive FEC-protected bytes (~1.75x input size + size byte)
+   * @param nibble 4-bit data value (0x0-0xF)
+   * @return Hamming codeword
    */
-  static inline void encode(const std::vector<uint8_t> &data, std::vector<uint8_t> &encoded) {
-    uint32_t accumulator = (encode_nibble(data.size() >> 4) << 7) | encode_nibble(data.size() & 0x0F);
-    int bits_in_accumulator = 14;
+  static constexpr uint8_t encode_nibble(uint8_t nibble) { return CODE::TABLES.encode[nibble & 0x0F]; }
 
-    encoded.clear();
+  /**
+   * @brief Number of encoded bytes for a payload
+   *
+   * @param len Data length
+   * @param crc CRC appended to the data
+   */
+  static constexpr std::size_t encoded_size(std::size_t len, CRCMode crc = CRC_NONE) {
+    return ((len + crc_size(crc) + (HEADER == CMT2300AHeader::LENGTH ? 1 : 0)) * STEP_BITS + 7) / 8;
+  }
 
-    for (uint8_t byte : data) {
-      uint8_t high_codeword = encode_nibble(byte >> 4);
-      uint8_t low_codeword = encode_nibble(byte & 0x0F);
+  /**
+   * @brief Encode a stream of bytes with FEC protection into a caller provided buffer
+   *
+   * Each byte is split into two nibbles, each encoded as a codeword,
+   * and packed into a continuous block stream. With the length header the size
+   * of the data is prepended as the first encoded byte to allow automatic size
+   * detection during decoding. Usable at compile time.
+   *
+   * @param data Input data bytes to encode (max 255 bytes, including the CRC)
+   * @param len Number of data bytes
+   * @param encoded Output buffer of encoded_size(len, crc) bytes
+   * @param crc CRC appended to the data, computed in the same pass
+   * @param whitening Sequence XORed with each byte, applied in the same pass
+   * @return Number of encoded bytes written
+   */
+  static constexpr std::size_t encode(const uint8_t *data, std::size_t len, uint8_t *encoded, CRCMode crc = CRC_NONE,
+                                      const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    uint32_t accumulator = 0;
+    int bits_in_accumulator = 0;
+    uint8_t position = 0;
+    std::size_t encoded_len = 0;
+
+    if (HEADER == CMT2300AHeader::LENGTH) {
+      encode_block((len + crc_size(crc)) ^ whitening.sequence[position++], accumulator, bits_in_accumulator, encoded,
+                   encoded_len);
+    }
 
-      // Combine into 14-bit block: [high_codeword (7 bits)][low_codeword (7 bits)]
-      uint16_t block_14 = (static_cast<uint16_t>(high_codeword) << 7) | low_codeword;
+    uint16_t crc_value = crc_init(crc);
 
-      // Add to accumulator
-      accumulator = (accumulator << 14) | block_14;
-      bits_in_accumulator += 14;
+    for (std::size_t i = 0; i < len; i++) {
+      crc_value = crc_update(crc, crc_value, data[i]);
+      encode_block(data[i] ^ whitening.sequence[position++], accumulator, bits_in_accumulator, encoded, encoded_len);
+    }
 
-      // Extract complete bytes from accumulator
-      while (bits_in_accumulator >= 8) {
-        // Extract top 8 bits
-        uint8_t output_byte = (accumulator >> (bits_in_accumulator - 8)) & 0xFF;
-        encoded.push_back(output_byte);
-        bits_in_accumulator -= 8;
-      }
+    // CRC is sent most significant byte first
+    if (crc == CRC_16) {
+      encode_block((crc_value >> 8) ^ whitening.sequence[position++], accumulator, bits_in_accumulator, encoded,
+                   encoded_len);
+    }
+    if (crc != CRC_NONE) {
+      encode_block((crc_value & 0xFF) ^ whitening.sequence[position++], accumulator, bits_in_accumulator, encoded,
+                   encoded_len);
     }
 
     // Flush remaining bits (if any)
     if (bits_in_accumulator > 0) {
       // Shift remaining bits to the left and pad with zeros
-      uint8_t output_byte = (accumulator << (8 - bits_in_accumulator)) & 0xFF;
-      encoded.push_back(output_byte);
+      encoded[encoded_len++] = (accumulator << (8 - bits_in_accumulator)) & 0xFF;
     }
+    return encoded_len;
+  }
+
+  /**
+   * @brief Encode a stream of bytes with FEC protection
+   *
+   * @param data Input data bytes to encode (max 255 bytes, including the CRC)
+   * @param encoded Output vector to receive FEC-protected bytes (~1.75x input size + size byte)
+   * @param crc CRC appended to the data, computed in the same pass
+   * @param whitening Sequence XORed with each byte, applied in the same pass
+   */
+  static inline void encode(const std::vector<uint8_t> &data, std::vector<uint8_t> &encoded, CRCMode crc = CRC_NONE,
+                            const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    encoded.resize(encoded_size(data.size(), crc));
+    encode(data.data(), data.size(), encoded.data(), crc, whitening);
   }
 
   /**
-   * @brief Decode and error-correct a single 7-bit codeword
+   * @brief Encode a constant payload at compile time
+   *
+   * The result can be placed in flash:
+   *   static constexpr auto FRAME = CMT2300A::encode_array<CMT2300A::CRC_16>(std::array<uint8_t, 2>{0x01, 0x02});
+   *
+   * @tparam CRC CRC appended to the data
+   * @param data Input data bytes to encode
+   * @param whitening Sequence XORed with each byte
+   * @return Encoded bytes, the same as encode
+   */
+  template<CRCMode CRC = CRC_NONE, std::size_t N>
+  static constexpr std::array<uint8_t, encoded_size(N, CRC)> encode_array(
+      const std::array<uint8_t, N> &data, const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    std::array<uint8_t, encoded_size(N, CRC)> encoded{};
+    encode(data.data(), N, encoded.data(), CRC, whitening);
+    return encoded;
+  }
+
+  /**
+   * @brief Decode and error-correct a single codeword
    *
    * Detects and corrects single-bit errors, extracts the 4-bit data nibble.
    *
-   * @param codeword 7-bit Hamming codeword
+   * @param codeword Hamming codeword
    * @param error_corrected Output reference - set to true if error was corrected, false otherwise
    * @return 4-bit decoded nibble (0x0-0xF)
    */
   static inline uint8_t decode_nibble(uint8_t codeword, bool &error_corrected) {
-    // Extract data and parity bits from the systematic code [d3 d2 d1 d0 | p2 p1 p0]
-    uint8_t d3 = (codeword >> 6) & 1;
-    uint8_t d2 = (codeword >> 5) & 1;
-    uint8_t d1 = (codeword >> 4) & 1;
-    uint8_t d0 = (codeword >> 3) & 1;
-
-    uint8_t p2_received = (codeword >> 2) & 1;
-    uint8_t p1_received = (codeword >> 1) & 1;
-    uint8_t p0_received = (codeword >> 0) & 1;
-
-    // Recompute parity bits from received data
-    uint8_t p2_computed = d3 ^ d1 ^ d0;
-    uint8_t p1_computed = d3 ^ d2 ^ d1;
-    uint8_t p0_computed = d2 ^ d1 ^ d0;
-
-    // Calculate syndrome (difference between computed and received parity)
-    uint8_t s2 = p2_computed ^ p2_received;
-    uint8_t s1 = p1_computed ^ p1_received;
-    uint8_t s0 = p0_computed ^ p0_received;
-
-    uint8_t syndrome = (s2 << 2) | (s1 << 1) | s0;
-
-    // No error detected
-    if (syndrome == 0) {
-      error_corrected = false;
-      return (d3 << 3) | (d2 << 2) | (d1 << 1) | d0;
-    }
+    uint8_t entry = CODE::TABLES.decode[codeword & ((1 << CODE::BITS) - 1)];
+    error_corrected = entry & CODE::CORRECTED;
+    return entry & 0x0F;
+  }
 
-    // Single-bit error detected - correct it
-    error_corrected = true;
-
-    // Apply correction by flipping the erroneous bit
-    uint8_t corrected_codeword = codeword;
-
-    switch (syndrome) {
-      case 0b001: // Error in p0 (bit 0)
-        corrected_codeword ^= (1 << 0);
-        break;
-      case 0b010: // Error in p1 (bit 1)
-        corrected_codeword ^= (1 << 1);
-        break;
-      case 0b011: // Error in d2 (bit 5)
-        corrected_codeword ^= (1 << 5);
-        break;
-      case 0b100: // Error in p2 (bit 2)
-        corrected_codeword ^= (1 << 2);
-        break;
-      case 0b101: // Error in d0 (bit 3)
-        corrected_codeword ^= (1 << 3);
-        break;
-      case 0b110: // Error in d3 (bit 6)
-        corrected_codeword ^= (1 << 6);
-        break;
-      case 0b111: // Error in d1 (bit 4)
-        corrected_codeword ^= (1 << 4);
-        break;
-      default:
-        // Should not happen for valid single-bit errors
-        break;
-    }
+  /**
+   * @brief Decode a stream of FEC-encoded bytes with error correction
+   *
+   * Processes a continuous stream of blocks, decoding and correcting
+   * errors automatically. With the length header the first decoded byte contains
+   * the expected size of the output data, allowing the decoder to stop at the
+   * correct length. Without it every complete block is decoded.
+   *
+   * Decodes into a caller provided buffer, no allocation is done.
+   *
+   * @param encoded Input encoded byte stream (must include size byte)
+   * @param encoded_len Number of encoded bytes
+   * @param decoded Output buffer to receive decoded bytes (excluding the size byte)
+   * @param capacity Size of the output buffer, 255 bytes is always enough with the length header
+   * @param decoded_len Output reference - number of bytes written to decoded
+   * @param valid Output reference - true if the size byte was decoded and that many bytes followed,
+   *              the CRC matched and no uncorrectable codeword was seen
+   * @param crc CRC expected after the data
+   * @param whitening Sequence the bytes were whitened with, removed in the same pass
+   * @return Number of single-bit errors corrected during decoding
+   */
+  static inline uint32_t decode(const uint8_t *encoded, std::size_t encoded_len, uint8_t *decoded,
+                                std::size_t capacity, std::size_t &decoded_len, bool &valid, CRCMode crc = CRC_NONE,
+                                const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    return decode_at(encoded, encoded_len, 0, decoded, capacity, decoded_len, valid, crc, whitening);
+  }
+
+  /**
+   * @brief Find the bit offset of the first block in a raw capture
+   *
+   * Every offset in the window is scored by the number of codewords with a zero
+   * syndrome among the first few, with the length header a plausible size breaks
+   * ties. The syndromes of 8 offsets are computed together on a 64-bit word.
+   *
+   * @param encoded Input encoded byte stream
+   * @param encoded_len Number of encoded bytes
+   * @param window Number of bit offsets to try, starting at 0
+   * @param whitening Sequence the bytes were whitened with, removed from the size byte
+   * @return Best bit offset, 0 on an empty input
+   */
+  static inline std::size_t find_sync(const uint8_t *encoded, std::size_t encoded_len, std::size_t window,
+                                      const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    std::size_t offset = 0;
+    find_sync(encoded, encoded_len, window, &offset, 1, whitening);
+    return offset;
+  }
 
-    // Extract corrected data bits
-    d3 = (corrected_codeword >> 6) & 1;
-    d2 = (corrected_codeword >> 5) & 1;
-    d1 = (corrected_codeword >> 4) & 1;
-    d0 = (corrected_codeword >> 3) & 1;
+  /**
+   * @brief Rank the bit offsets of the first block in a raw capture
+   *
+   * Scored like find_sync. An all-zero codeword has a zero syndrome, so over
+   * leading zeros the offsets a whole number of codewords before the frame
+   * score as high as the frame itself, and misaligned offsets can tie by
+   * chance.
+   *
+   * @param encoded Input encoded byte stream
+   * @param encoded_len Number of encoded bytes
+   * @param window Number of bit offsets to try, starting at 0
+   * @param offsets Output buffer, the best offset first, equal scores in window order
+   * @param count Number of offsets wanted, at most SYNC_CANDIDATES
+   * @param whitening Sequence the bytes were whitened with, removed from the size byte
+   * @return Number of offsets written
+   */
+  static inline std::size_t find_sync(const uint8_t *encoded, std::size_t encoded_len, std::size_t window,
+                                      std::size_t *offsets, std::size_t count,
+                                      const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    uint8_t scores[SYNC_CANDIDATES];
+    std::size_t found = 0;
+    if (count > SYNC_CANDIDATES) {
+      count = SYNC_CANDIDATES;
+    }
 
-    return (d3 << 3) | (d2 << 2) | (d1 << 1) | d0;
+    for (std::size_t start = 0; start < window && start / 8 < encoded_len; start += 8) {
+      uint64_t stream = 0;
+      for (std::size_t i = start / 8; i < start / 8 + 8; i++) {
+        stream = (stream << 8) | (i < encoded_len ? encoded[i] : 0);
+      }
+      uint64_t zero = CODE::syndrome_zero(stream);
+
+      for (std::size_t bit = 0; bit < 8 && start + bit < window; bit++) {
+        std::size_t offset = start + bit;
+        int score = 0;
+        for (int c = 0; c < SYNC_CODEWORDS; c++) {
+          // codewords running into the padding don't count
+          if (offset + (c + 1) * CODE::BITS <= encoded_len * 8) {
+            score += (zero >> (63 - bit - c * CODE::BITS)) & 1;
+          }
+        }
+        score *= 2;
+        if (HEADER == CMT2300AHeader::LENGTH) {
+          uint32_t block = (stream >> (64 - bit - BLOCK_BITS)) & ((1 << BLOCK_BITS) - 1);
+          uint8_t size = ((CODE::TABLES.decode[block >> CODE::BITS] << 4) |
+                          (CODE::TABLES.decode[block & ((1 << CODE::BITS) - 1)] & 0x0F)) ^
+                         whitening.sequence[0];
+          if (offset + (size + 1) * STEP_BITS <= encoded_len * 8) {
+            score++;
+          }
+        }
+        // insert behind every offset scoring the same or better, the first found wins a tie
+        std::size_t pos = found;
+        while (pos > 0 && scores[pos - 1] < score) {
+          pos--;
+        }
+        if (pos >= count) {
+          continue;
+        }
+        if (found < count) {
+          found++;
+        }
+        for (std::size_t i = found - 1; i > pos; i--) {
+          scores[i] = scores[i - 1];
+          offsets[i] = offsets[i - 1];
+        }
+        scores[pos] = score;
+        offsets[pos] = offset;
+      }
+    }
+    if (found == 0 && count > 0) {
+      offsets[0] = 0;
+      found = 1;
+    }
+    return found;
   }
 
   /**
-   * @brief Decode a stream of FEC-encoded bytes with error correction
+   * @brief Decode a raw capture whose first block may not be byte aligned
    *
-   * Processes a continuous stream of 14-bit blocks, decoding and correcting
-   * errors automatically. The first decoded byte contains the expected size
-   * of the output data, allowing the decoder to stop at the correct length.
+   * Like decode, after finding the start of the first block with find_sync.
+   * With a CRC the offsets are tried best first until a frame checks out, if
+   * none does the best offset is decoded. A CRC-8 matches a wrong offset
+   * about once in 256 tries, CRC-16 is preferable with a large window.
    *
-   * @param encoded Input encoded byte stream (must include size byte)
-   * @param decoded Output vector to receive decoded bytes (excluding the size byte)
+   * @param bit_offset Output reference - bit offset the frame was decoded at
+   * @param window Number of bit offsets to try, starting at 0
    * @return Number of single-bit errors corrected during decoding
    */
-  static inline uint32_t decode(const std::vector<uint8_t> &encoded, std::vector<uint8_t> &decoded) {
-    std::size_t size = std::numeric_limits<std::size_t>::max();
-    uint32_t remainder = 0;
-    uint32_t data = 0;
+  static inline uint32_t decode_sync(const uint8_t *encoded, std::size_t encoded_len, uint8_t *decoded,
+                                     std::size_t capacity, std::size_t &decoded_len, bool &valid,
+                                     std::size_t &bit_offset, std::size_t window, CRCMode crc = CRC_NONE,
+                                     const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    std::size_t offsets[SYNC_CANDIDATES];
+    std::size_t found =
+        find_sync(encoded, encoded_len, window, offsets, crc == CRC_NONE ? 1 : SYNC_CANDIDATES, whitening);
+    for (std::size_t i = 0; i < found; i++) {
+      bit_offset = offsets[i];
+      uint32_t corrected_errors =
+          decode_at(encoded, encoded_len, bit_offset, decoded, capacity, decoded_len, valid, crc, whitening);
+      if (valid || found == 1) {
+        return corrected_errors;
+      }
+    }
+    bit_offset = offsets[0];
+    return decode_at(encoded, encoded_len, bit_offset, decoded, capacity, decoded_len, valid, crc, whitening);
+  }
+
+  /**
+   * @brief Decode a stream of FEC-encoded bytes starting at a bit offset
+   *
+   * @param bit_offset Bit of the first block, counted from the most significant bit of the first byte
+   * @return Number of single-bit errors corrected during decoding
+   */
+  static inline uint32_t decode_at(const uint8_t *encoded, std::size_t encoded_len, std::size_t bit_offset,
+                                   uint8_t *decoded, std::size_t capacity, std::size_t &decoded_len, bool &valid,
+                                   CRCMode crc = CRC_NONE, const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    std::size_t size = HEADER == CMT2300AHeader::LENGTH ? std::numeric_limits<std::size_t>::max() : capacity;
+    std::size_t received = 0;
+    // bits above the offset in the first byte are shifted in but never extracted
+    int remainder = -static_cast<int>(bit_offset % 8);
+    // repeated blocks don't fit 32 bits
+    typename std::conditional<(STEP_BITS + 8 > 32), uint64_t, uint32_t>::type data = 0;
 
-    uint32_t total_codewords = 0;
     uint32_t corrected_errors = 0;
+    uint8_t flags = 0;
+    uint8_t position = 0;
+
+    uint16_t crc_value = crc_init(crc);
+    uint16_t crc_received = 0;
 
-    decoded.clear();
+    decoded_len = 0;
+    valid = false;
 
     // Process the input byte stream
-    for (uint8_t byte : encoded) {
+    for (std::size_t i = bit_offset / 8; i < encoded_len; i++) {
       // Shift in new byte
-      data = (data << 8) | byte;
+      data = (data << 8) | encoded[i];
       remainder += 8;
 
-      // Extract and decode 14-bit blocks
-      if (remainder >= 14) {
-        // Extract 14-bit block from the bit stream
-        uint16_t block_14 = (data >> (remainder - 14)) & 0x3FFF;
-
-        // Split into two 7-bit codewords
-        // High 7 bits [13:7] encode the high nibble
-        // Low 7 bits [6:0] encode the low nibble
-        uint8_t high_codeword = (block_14 >> 7) & 0x7F;
-        uint8_t low_codeword = block_14 & 0x7F;
-
-        // Decode both codewords with error correction
-        bool high_corrected = false;
-        bool low_corrected = false;
+      // Extract and decode blocks
+      if (remainder >= STEP_BITS) {
+        // Extract block from the bit stream
+        uint32_t block = (data >> (remainder - BLOCK_BITS)) & ((1 << BLOCK_BITS) - 1);
+
+        if (REPEAT == 3) {
+          uint32_t second = (data >> (remainder - 2 * BLOCK_BITS)) & ((1 << BLOCK_BITS) - 1);
+          uint32_t third = (data >> (remainder - 3 * BLOCK_BITS)) & ((1 << BLOCK_BITS) - 1);
+          // a codeword whose copies disagree counts as corrected
+          uint32_t disagree = (block ^ second) | (block ^ third);
+          corrected_errors += ((disagree >> CODE::BITS) != 0) + ((disagree & ((1 << CODE::BITS) - 1)) != 0);
+          block = (block & second) | (block & third) | (second & third);
+        }
 
-        uint8_t high_nibble = decode_nibble(high_codeword, high_corrected);
-        uint8_t low_nibble = decode_nibble(low_codeword, low_corrected);
+        // Split into two codewords, the high one encodes the high nibble
+        uint8_t high_entry = CODE::TABLES.decode[block >> CODE::BITS];
+        uint8_t low_entry = CODE::TABLES.decode[block & ((1 << CODE::BITS) - 1)];
 
-        if (high_corrected || low_corrected) {
-          ESP_LOGV("CMT2300A", "Error in byte %d", decoded.size());
+        if ((high_entry | low_entry) & CODE::CORRECTED) {
+          ESP_LOGV("CMT2300A", "Error in byte %u", (unsigned) received);
         }
 
         // Update statistics
-        total_codewords += 2;
-        if (high_corrected) corrected_errors++;
-        if (low_corrected) corrected_errors++;
+        corrected_errors += ((high_entry & CODE::CORRECTED) != 0) + ((low_entry & CODE::CORRECTED) != 0);
+        flags |= high_entry | low_entry;
 
         // Combine nibbles into output byte
-        uint8_t decoded_byte = (high_nibble << 4) | low_nibble;
+        uint8_t decoded_byte = ((high_entry << 4) | (low_entry & 0x0F)) ^ whitening.sequence[position++];
         if (size == std::numeric_limits<std::size_t>::max()) {
           size = decoded_byte;
-        } else {
-          decoded.push_back(decoded_byte);
-          if (decoded.size() >= size) {
+          if (size < crc_size(crc)) {
             break;
           }
+        } else if (HEADER == CMT2300AHeader::NONE) {
+          // Size is unknown, the last bytes are the CRC so it trails behind
+          if (decoded_len >= capacity) {
+            break;
+          }
+          decoded[decoded_len++] = decoded_byte;
+          if (decoded_len > crc_size(crc)) {
+            crc_value = crc_update(crc, crc_value, decoded[decoded_len - 1 - crc_size(crc)]);
+          }
+          received++;
+        } else if (received < size - crc_size(crc)) {
+          // Payload byte, checked in the same pass
+          if (decoded_len >= capacity) {
+            break;
+          }
+          decoded[decoded_len++] = decoded_byte;
+          crc_value = crc_update(crc, crc_value, decoded_byte);
+          received++;
+        } else {
+          // Trailing CRC byte
+          crc_received = (crc_received << 8) | decoded_byte;
+          received++;
         }
-        remainder -= 14;
+        if (received >= size) {
+          valid = crc == CRC_NONE || crc_received == crc_value;
+          break;
+        }
+        remainder -= STEP_BITS;
       }
     }
+
+    if (HEADER == CMT2300AHeader::NONE && decoded_len >= crc_size(crc) && decoded_len > 0) {
+      for (uint8_t n = crc_size(crc); n > 0; n--) {
+        crc_received = (crc_received << 8) | decoded[decoded_len - n];
+      }
+      decoded_len -= crc_size(crc);
+      valid = crc == CRC_NONE || crc_received == crc_value;
+    }
+
+    if (flags & CODE::UNCORRECTABLE) {
+      valid = false;
+    }
     return corrected_errors;
   }
 
- private:
   /**
-   * @brief Compute 3-bit parity for a 4-bit data nibble
+   * @brief Decode a stream of FEC-encoded bytes with error correction
+   *
+   * Processes a continuous stream of blocks, decoding and correcting
+   * errors automatically. The first decoded byte contains the expected size
+   * of the output data, allowing the decoder to stop at the correct length.
    *
-   * @param nibble 4-bit data nibble
-   * @return 3-bit parity value
+   * @param encoded Input encoded byte stream (must include size byte)
+   * @param decoded Output vector to receive decoded bytes (excluding the size byte and CRC)
+   * @param crc CRC expected after the data, the data is cleared if it doesn't match
+   * @param whitening Sequence the bytes were whitened with
+   * @return Number of single-bit errors corrected during decoding
    */
-  static inline uint8_t compute_parity(uint8_t nibble) {
-    // Extract data bits
-    uint8_t d3 = (nibble >> 3) & 1;
-    uint8_t d2 = (nibble >> 2) & 1;
-    uint8_t d1 = (nibble >> 1) & 1;
-    uint8_t d0 = nibble & 1;
-
-    // Compute parity bits according to generator polynomial g(x) = x³ + x² + 1
-    // p2 = d3 ⊕ d1 ⊕ d0
-    // p1 = d3 ⊕ d2 ⊕ d1
-    // p0 = d2 ⊕ d1 ⊕ d0
-    uint8_t p2 = d3 ^ d1 ^ d0;
-    uint8_t p1 = d3 ^ d2 ^ d1;
-    uint8_t p0 = d2 ^ d1 ^ d0;
-
-    return (p2 << 2) | (p1 << 1) | p0;
+  static inline uint32_t decode(const std::vector<uint8_t> &encoded, std::vector<uint8_t> &decoded,
+                                CRCMode crc = CRC_NONE, const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    std::size_t decoded_len;
+    bool valid;
+
+    decoded.resize(HEADER == CMT2300AHeader::LENGTH ? std::numeric_limits<uint8_t>::max()
+                                                    : encoded.size() * 8 / STEP_BITS);
+    uint32_t corrected_errors =
+        decode(encoded.data(), encoded.size(), decoded.data(), decoded.size(), decoded_len, valid, crc, whitening);
+    if (crc != CRC_NONE && !valid) {
+      decoded_len = 0;
+    }
+    decoded.resize(decoded_len);
+    return corrected_errors;
+  }
+
+ private:
+  /**
+   * @brief Append one byte as a block and emit complete output bytes
+   */
+  static constexpr void encode_block(uint8_t byte, uint32_t &accumulator, int &bits_in_accumulator, uint8_t *encoded,
+                                     std::size_t &encoded_len) {
+    // Combine into block: [high_codeword][low_codeword]
+    uint32_t block = (static_cast<uint32_t>(encode_nibble(byte >> 4)) << CODE::BITS) | encode_nibble(byte & 0x0F);
+
+    for (int copy = 0; copy < REPEAT; copy++) {
+      // Add to accumulator
+      accumulator = (accumulator << BLOCK_BITS) | block;
+      bits_in_accumulator += BLOCK_BITS;
+
+      // Extract complete bytes from accumulator
+      while (bits_in_accumulator >= 8) {
+        // Extract top 8 bits
+        encoded[encoded_len++] = (accumulator >> (bits_in_accumulator - 8)) & 0xFF;
+        bits_in_accumulator -= 8;
+      }
+    }
   }
 };
 
+/**
+ * @brief Hamming(7,4) data first with the length header
+ */
+using CMT2300A = BasicCMT2300A<>;
+
+static_assert(CMT2300AHamming<>::TABLES.encode[0x1] == 0b0001101 && CMT2300AHamming<>::TABLES.encode[0x8] == 0b1000110,
+              "default code must match the parity equations above");
+
+// the compile time encoder must give the frames the original runtime encoder did
+static_assert(cmt2300a_detail::equal(
+                  CMT2300A::encode_array(std::array<uint8_t, 5>{0x95, 0xA0, 0x11, 0x21, 0xAE}),
+                  std::array<uint8_t, 11>{0x00, 0xBA, 0x5A, 0xEA, 0x20, 0x06, 0x8D, 0x2E, 0x36, 0x8F, 0x20}),
+              "compile time encoding must match the runtime encoder");
+
 #endif // CMT2300A_H
@@ -0,0 +1,326 @@
+/**
+ * @file cmt2300a_adaptive.h
+ * @brief Per frame FEC rate selection for CMT2300A links
+ *
+ * Every frame starts with an uncoded mode byte followed by the body:
+ *
+ *   UNCODED  0x0F  [size | data | crc], rate 1
+ *   HAMMING  0xF0  CMT2300A frame, rate 4/7
+ *   REPEAT   0x3C  CMT2300A frame with every block sent three times, rate 4/21
+ *
+ * The mode bytes are at least 4 bits apart, a single bit error is corrected.
+ *
+ * The sender picks the rate from the errors the decoder reported on recently
+ * received frames. This assumes a reciprocal link, the errors seen on the
+ * peer's frames stand in for the errors the peer will see.
+ */
+
+#ifndef CMT2300A_ADAPTIVE_H
+#define CMT2300A_ADAPTIVE_H
+
+#include "cmt2300a.h"
+#include <cmath>
+
+class CMT2300AAdaptive : public CMT2300ABase {
+ public:
+  enum Rate : uint8_t {
+    RATE_UNCODED = 0,
+    RATE_HAMMING = 1,
+    RATE_REPEAT = 2,
+  };
+
+  using Repeat = BasicCMT2300A<CMT2300AHamming<>, CMT2300AHeader::LENGTH, 3>;
+
+  /**
+   * @brief Mode byte sent for a rate
+   */
+  static constexpr uint8_t mode(Rate rate) { return rate == RATE_UNCODED ? 0x0F : rate == RATE_HAMMING ? 0xF0 : 0x3C; }
+
+  /**
+   * @brief Encoded size of a frame, including the mode byte
+   *
+   * @param rate Rate the frame is sent at
+   * @param len Data length
+   * @param crc CRC appended to the data
+   * @return Number of encoded bytes
+   */
+  static constexpr std::size_t encoded_size(Rate rate, std::size_t len, CRCMode crc) {
+    std::size_t bytes = 1 + len + crc_size(crc);
+    if (rate == RATE_UNCODED) {
+      return 1 + bytes;
+    }
+    return 1 + (bytes * (rate == RATE_HAMMING ? CMT2300A::STEP_BITS : Repeat::STEP_BITS) + 7) / 8;
+  }
+
+  /**
+   * @brief Encode a frame at a rate
+   *
+   * @param rate Rate the frame is sent at
+   * @param data Input data bytes to encode (max 255 bytes, including the CRC)
+   * @param encoded Output vector to receive the mode byte and body
+   * @param crc CRC appended to the data
+   * @param whitening Sequence XORed with each byte after the mode byte
+   */
+  static inline void encode(Rate rate, const std::vector<uint8_t> &data, std::vector<uint8_t> &encoded,
+                            CRCMode crc = CRC_NONE, const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    if (rate == RATE_UNCODED) {
+      uint8_t position = 0;
+      encoded.clear();
+      encoded.push_back(mode(rate));
+      encoded.push_back((data.size() + crc_size(crc)) ^ whitening.sequence[position++]);
+      uint16_t crc_value = crc_init(crc);
+      for (uint8_t byte : data) {
+        crc_value = crc_update(crc, crc_value, byte);
+        encoded.push_back(byte ^ whitening.sequence[position++]);
+      }
+      if (crc == CRC_16) {
+        encoded.push_back((crc_value >> 8) ^ whitening.sequence[position++]);
+      }
+      if (crc != CRC_NONE) {
+        encoded.push_back((crc_value & 0xFF) ^ whitening.sequence[position++]);
+      }
+      return;
+    }
+    if (rate == RATE_HAMMING) {
+      CMT2300A::encode(data, encoded, crc, whitening);
+    } else {
+      Repeat::encode(data, encoded, crc, whitening);
+    }
+    encoded.insert(encoded.begin(), mode(rate));
+  }
+
+  /**
+   * @brief Decode a frame at the rate given by its mode byte
+   *
+   * Decodes into a caller provided buffer, no allocation is done.
+   *
+   * @param encoded Input encoded byte stream, starting with the mode byte
+   * @param encoded_len Number of encoded bytes
+   * @param decoded Output buffer to receive decoded bytes
+   * @param capacity Size of the output buffer, 255 bytes is always enough
+   * @param decoded_len Output reference - number of bytes written to decoded
+   * @param valid Output reference - true if a known mode and the whole frame were decoded and the CRC matched
+   * @param rate Output reference - rate the frame was sent at
+   * @param crc CRC expected after the data
+   * @param whitening Sequence the bytes after the mode byte were whitened with
+   * @return Number of errors corrected during decoding, uncoded frames only count the mode byte
+   */
+  static inline uint32_t decode(const uint8_t *encoded, std::size_t encoded_len, uint8_t *decoded,
+                                std::size_t capacity, std::size_t &decoded_len, bool &valid, Rate &rate,
+                                CRCMode crc = CRC_NONE, const CMT2300AWhitening &whitening = CMT2300A_NO_WHITENING) {
+    decoded_len = 0;
+    valid = false;
+    rate = RATE_HAMMING;
+    if (encoded_len < 2) {
+      return 0;
+    }
+
+    // nearest mode byte, two or more bit errors are not trusted
+    uint32_t corrected_errors = 0;
+    int best_distance = 9;
+    for (uint8_t r = RATE_UNCODED; r <= RATE_REPEAT; r++) {
+      int distance = __builtin_popcount(encoded[0] ^ mode(static_cast<Rate>(r)));
+      if (distance < best_distance) {
+        best_distance = distance;
+        rate = static_cast<Rate>(r);
+      }
+    }
+    if (best_distance > 1) {
+      return 0;
+    }
+    corrected_errors += best_distance;
+
+    if (rate == RATE_HAMMING) {
+      corrected_errors +=
+          CMT2300A::decode(encoded + 1, encoded_len - 1, decoded, capacity, decoded_len, valid, crc, whitening);
+      return corrected_errors;
+    }
+    if (rate == RATE_REPEAT) {
+      corrected_errors +=
+          Repeat::decode(encoded + 1, encoded_len - 1, decoded, capacity, decoded_len, valid, crc, whitening);
+      return corrected_errors;
+    }
+
+    std::size_t size = encoded[1] ^ whitening.sequence[0];
+    if (size < crc_size(crc) || size - crc_size(crc) > capacity || size + 2 > encoded_len) {
+      return corrected_errors;
+    }
+    uint16_t crc_value = crc_init(crc);
+    for (std::size_t i = 0; i < size - crc_size(crc); i++) {
+      decoded[i] = encoded[2 + i] ^ whitening.sequence[1 + i];
+      crc_value = crc_update(crc, crc_value, decoded[i]);
+    }
+    uint16_t crc_received = 0;
+    for (std::size_t i = size - crc_size(crc); i < size; i++) {
+      crc_received = (crc_received << 8) | (encoded[2 + i] ^ whitening.sequence[(1 + i) & 0xFF]);
+    }
+    decoded_len = size - crc_size(crc);
+    valid = crc == CRC_NONE || crc_received == crc_value;
+    return corrected_errors;
+  }
+};
+
+/**
+ * @brief Picks the rate for the next frame from the errors on recent frames
+ *
+ * The bit error rate is estimated over a sliding window of received frames,
+ * from the corrected errors per coded bit and from the share of frames that
+ * failed. The rate with the best expected goodput (code rate times the chance
+ * the frame decodes) is used, a change needs a margin over the current rate.
+ *
+ * @tparam WINDOW Number of frames in the sliding window
+ */
+template<std::size_t WINDOW = 16> class CMT2300ARateController {
+ public:
+  /**
+   * @brief Goodput gain in percent needed to change the rate
+   */
+  void set_margin(uint8_t margin) { this->margin_ = margin; }
+
+  CMT2300AAdaptive::Rate get_rate() const { return this->rate_; }
+  float get_bit_error_rate() const { return this->bit_error_rate_; }
+
+  /**
+   * @brief Chance a frame decodes
+   *
+   * @param rate Rate the frame is sent at
+   * @param bit_error_rate Bit error rate of the channel
+   * @param bytes Bytes in the frame, including the size byte and CRC
+   */
+  static float success(CMT2300AAdaptive::Rate rate, float bit_error_rate, float bytes) {
+    float p = bit_error_rate;
+    if (rate == CMT2300AAdaptive::RATE_UNCODED) {
+      return powf(1.0f - p, 8.0f * bytes);
+    }
+    if (rate == CMT2300AAdaptive::RATE_REPEAT) {
+      // majority of three copies is wrong
+      p = p * p * (3.0f - 2.0f * p);
+    }
+    // a codeword corrects one error
+    float codeword = powf(1.0f - p, 7.0f) + 7.0f * p * powf(1.0f - p, 6.0f);
+    return powf(codeword, 2.0f * bytes);
+  }
+
+  /**
+   * @brief Data bits per bit sent
+   */
+  static constexpr float efficiency(CMT2300AAdaptive::Rate rate) {
+    if (rate == CMT2300AAdaptive::RATE_UNCODED) {
+      return 1.0f;
+    }
+    return rate == CMT2300AAdaptive::RATE_HAMMING ? 4.0f / 7 : 4.0f / 21;
+  }
+
+  /**
+   * @brief Add a received frame
+   *
+   * @param rate Rate the frame was sent at
+   * @param errors Errors corrected while decoding it
+   * @param decoded_len Decoded bytes, excluding the CRC
+   * @param valid Whether it decoded
+   * @return True if the rate changed
+   */
+  bool add(CMT2300AAdaptive::Rate rate, uint32_t errors, std::size_t decoded_len, bool valid) {
+    Sample &sample = this->samples_[this->next_];
+    sample.rate = rate;
+    sample.valid = valid;
+    sample.errors = errors;
+    sample.bytes = decoded_len + 1;
+    this->next_ = (this->next_ + 1) % WINDOW;
+    if (this->count_ < WINDOW) {
+      this->count_++;
+    }
+    if (this->count_ < MIN_SAMPLES) {
+      return false;
+    }
+
+    float bytes = this->estimate_();
+    float current = efficiency(this->rate_) * success(this->rate_, this->bit_error_rate_, bytes);
+    CMT2300AAdaptive::Rate best = this->rate_;
+    float best_goodput = current * (1.0f + this->margin_ / 100.0f);
+    for (uint8_t r = CMT2300AAdaptive::RATE_UNCODED; r <= CMT2300AAdaptive::RATE_REPEAT; r++) {
+      auto candidate = static_cast<CMT2300AAdaptive::Rate>(r);
+      float goodput = efficiency(candidate) * success(candidate, this->bit_error_rate_, bytes);
+      if (goodput > best_goodput) {
+        best = candidate;
+        best_goodput = goodput;
+      }
+    }
+    if (best == this->rate_) {
+      return false;
+    }
+    this->rate_ = best;
+    return true;
+  }
+
+ protected:
+  static constexpr std::size_t MIN_SAMPLES = 4;
+
+  struct Sample {
+    CMT2300AAdaptive::Rate rate;
+    bool valid;
+    uint32_t errors;
+    uint32_t bytes;
+  };
+
+  /**
+   * @brief Estimate the bit error rate over the window
+   *
+   * @return Average bytes in a valid frame
+   */
+  float estimate_() {
+    uint32_t errors = 0;
+    uint32_t coded_bits = 0;
+    uint32_t bytes = 0;
+    uint32_t frames[3]{};
+    uint32_t failures[3]{};
+    for (std::size_t i = 0; i < this->count_; i++) {
+      const Sample &sample = this->samples_[i];
+      frames[sample.rate]++;
+      if (!sample.valid) {
+        failures[sample.rate]++;
+        continue;
+      }
+      bytes += sample.bytes;
+      if (sample.rate != CMT2300AAdaptive::RATE_UNCODED) {
+        errors += sample.errors;
+        coded_bits += sample.bytes * (sample.rate == CMT2300AAdaptive::RATE_HAMMING ? 14 : 42);
+      }
+    }
+    uint32_t valid = this->count_ - failures[0] - failures[1] - failures[2];
+    float avg_bytes = valid > 0 ? float(bytes) / valid : 32.0f;
+
+    float p = coded_bits > 0 ? float(errors) / coded_bits : 0.0f;
+    for (uint8_t r = CMT2300AAdaptive::RATE_UNCODED; r <= CMT2300AAdaptive::RATE_REPEAT; r++) {
+      if (failures[r] == 0) {
+        continue;
+      }
+      // invert the chance of success, keeping it away from 0
+      float failed = (failures[r] - 0.5f) / frames[r];
+      float q;
+      if (r == CMT2300AAdaptive::RATE_UNCODED) {
+        q = 1.0f - powf(1.0f - failed, 1.0f / (8.0f * avg_bytes));
+      } else {
+        // a frame fails on two errors in a codeword, 21 p^2 for each of 2 codewords per byte
+        q = sqrtf(failed / (42.0f * avg_bytes));
+        if (r == CMT2300AAdaptive::RATE_REPEAT) {
+          q = sqrtf(q / 3.0f);
+        }
+      }
+      if (q > p) {
+        p = q;
+      }
+    }
+    this->bit_error_rate_ = p;
+    return avg_bytes;
+  }
+
+  CMT2300AAdaptive::Rate rate_{CMT2300AAdaptive::RATE_HAMMING};
+  uint8_t margin_{10};
+  float bit_error_rate_{0.0f};
+  std::size_t count_{0};
+  std::size_t next_{0};
+  Sample samples_[WINDOW]{};
+};
+
+#endif  // CMT2300A_ADAPTIVE_H
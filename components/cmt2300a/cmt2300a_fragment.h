@@ -0,0 +1,193 @@
+/**
+ * @file cmt2300a_fragment.h
+ * @brief Fragmentation and reassembly of messages larger than one CMT2300A frame
+ *
+ * The length header of a frame is one byte, so a message is split into
+ * fragments that each fit a frame. Every fragment starts with a header:
+ *
+ *   [magic | id | index | count | size]
+ *   - magic: 0xF5, frames from other devices on the channel are rarely taken for fragments
+ *   - id:    Message ID, the same for all fragments of a message
+ *   - index: Fragment index, 0 to count - 1
+ *   - count: Number of fragments in the message
+ *   - size:  Data bytes in every fragment but the last
+ *
+ * The receiver copies each fragment into a fixed-size slot at index * size,
+ * the completed message is handed out in place.
+ */
+
+#ifndef CMT2300A_FRAGMENT_H
+#define CMT2300A_FRAGMENT_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class CMT2300AFragmenter {
+ public:
+  static constexpr std::size_t HEADER_SIZE = 5;
+  static constexpr uint8_t MAGIC = 0xF5;
+
+  /**
+   * @brief Number of fragments needed for a message
+   *
+   * @param len Message length
+   * @param size Data bytes per fragment (1-255)
+   * @return Number of fragments, 0 if the message needs more than 255
+   */
+  static inline uint8_t count(std::size_t len, uint8_t size) {
+    std::size_t count = len == 0 ? 1 : (len + size - 1) / size;
+    return count > 255 ? 0 : count;
+  }
+
+  /**
+   * @brief Build one fragment of a message
+   *
+   * @param data Message
+   * @param len Message length
+   * @param id Message ID
+   * @param size Data bytes per fragment (1-255)
+   * @param index Fragment to build, below count(len, size)
+   * @param fragment Output vector to receive the header and data
+   */
+  static inline void fragment(const uint8_t *data, std::size_t len, uint8_t id, uint8_t size, uint8_t index,
+                              std::vector<uint8_t> &fragment) {
+    std::size_t offset = static_cast<std::size_t>(index) * size;
+    std::size_t chunk = offset + size > len ? len - offset : size;
+
+    fragment.resize(HEADER_SIZE + chunk);
+    fragment[0] = MAGIC;
+    fragment[1] = id;
+    fragment[2] = index;
+    fragment[3] = count(len, size);
+    fragment[4] = size;
+    std::memcpy(fragment.data() + HEADER_SIZE, data + offset, chunk);
+  }
+};
+
+/**
+ * @brief Bounded pool of reassembly slots
+ *
+ * No allocation after construction. A slot is evicted when no fragment was
+ * added for the timeout, or when a new message needs a slot and all are in use
+ * (the least recently updated goes). A completed message keeps its slot until
+ * the timeout so retransmitted fragments aren't delivered twice.
+ *
+ * @tparam SLOTS Number of messages reassembled at the same time
+ * @tparam MAX_MESSAGE Largest message in bytes
+ */
+template<std::size_t SLOTS = 4, std::size_t MAX_MESSAGE = 1024> class CMT2300AReassembler {
+ public:
+  explicit CMT2300AReassembler(uint32_t timeout = 5000) : timeout_(timeout) {}
+
+  /**
+   * @brief Add a received fragment
+   *
+   * @param fragment Fragment header and data
+   * @param len Fragment length
+   * @param now Current time in ms
+   * @param message_len Output reference - length of the completed message
+   * @return The completed message, valid until the next call, or nullptr, also for frames that aren't fragments
+   */
+  const uint8_t *add(const uint8_t *fragment, std::size_t len, uint32_t now, std::size_t &message_len) {
+    message_len = 0;
+    if (len < CMT2300AFragmenter::HEADER_SIZE || fragment[0] != CMT2300AFragmenter::MAGIC) {
+      return nullptr;
+    }
+    uint8_t id = fragment[1];
+    uint8_t index = fragment[2];
+    uint8_t count = fragment[3];
+    uint8_t size = fragment[4];
+    std::size_t chunk = len - CMT2300AFragmenter::HEADER_SIZE;
+    std::size_t offset = static_cast<std::size_t>(index) * size;
+
+    // every fragment but the last is full, nothing may run past the slot
+    if (index >= count || size == 0 || chunk > size || (index + 1 < count && chunk != size) ||
+        offset + chunk > MAX_MESSAGE) {
+      this->rejected_++;
+      return nullptr;
+    }
+
+    Slot *slot = this->find_(id, count, size, now);
+    if (slot->state == DONE || (slot->received[index / 32] & (1u << (index % 32)))) {
+      // duplicate
+      slot->last_update = now;
+      return nullptr;
+    }
+    std::memcpy(slot->data + offset, fragment + CMT2300AFragmenter::HEADER_SIZE, chunk);
+    slot->received[index / 32] |= 1u << (index % 32);
+    slot->remaining--;
+    slot->last_update = now;
+    if (index + 1 == count) {
+      slot->len = offset + chunk;
+    }
+    if (slot->remaining > 0) {
+      return nullptr;
+    }
+    // the data stays in place until the slot is reused
+    slot->state = DONE;
+    message_len = slot->len;
+    return slot->data;
+  }
+
+  uint32_t get_evicted() const { return this->evicted_; }
+  uint32_t get_rejected() const { return this->rejected_; }
+
+ protected:
+  // ordered by preference when a slot is needed
+  enum SlotState : uint8_t {
+    FREE,
+    DONE,
+    ACTIVE,
+  };
+
+  struct Slot {
+    SlotState state{FREE};
+    uint8_t id{0};
+    uint8_t count{0};
+    uint8_t size{0};
+    uint16_t remaining{0};
+    std::size_t len{0};
+    uint32_t last_update{0};
+    uint32_t received[8]{};
+    uint8_t data[MAX_MESSAGE];
+  };
+
+  Slot *find_(uint8_t id, uint8_t count, uint8_t size, uint32_t now) {
+    Slot *free_slot = nullptr;
+    for (auto &slot : this->slots_) {
+      if (slot.state != FREE && now - slot.last_update > this->timeout_) {
+        if (slot.state == ACTIVE) {
+          this->evicted_++;
+        }
+        slot.state = FREE;
+      }
+      if (slot.state != FREE && slot.id == id && slot.count == count && slot.size == size) {
+        return &slot;
+      }
+      // prefer a free slot, then the oldest completed one, then the oldest incomplete one
+      if (free_slot == nullptr || slot.state < free_slot->state ||
+          (slot.state == free_slot->state && now - slot.last_update > now - free_slot->last_update)) {
+        free_slot = &slot;
+      }
+    }
+    if (free_slot->state == ACTIVE) {
+      this->evicted_++;
+    }
+    free_slot->state = ACTIVE;
+    free_slot->id = id;
+    free_slot->count = count;
+    free_slot->size = size;
+    free_slot->remaining = count;
+    free_slot->len = 0;
+    std::memset(free_slot->received, 0, sizeof(free_slot->received));
+    return free_slot;
+  }
+
+  uint32_t timeout_;
+  uint32_t evicted_{0};
+  uint32_t rejected_{0};
+  Slot slots_[SLOTS];
+};
+
+#endif  // CMT2300A_FRAGMENT_H
@@ -0,0 +1,167 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome import automation
+from esphome.components import sx126x
+from esphome.const import CONF_DATA, CONF_ID
+
+CODEOWNERS = ["@swoboda1337"]
+DEPENDENCIES = ["sx126x"]
+AUTO_LOAD = ["cmt2300a"]
+
+CONF_SX126X_ID = "sx126x_id"
+CONF_ON_DECODED = "on_decoded"
+CONF_CRC = "crc"
+CONF_SYNC_WINDOW = "sync_window"
+CONF_FRAGMENT_SIZE = "fragment_size"
+CONF_REASSEMBLY_TIMEOUT = "reassembly_timeout"
+CONF_ON_MESSAGE = "on_message"
+CONF_ADAPTIVE_RATE = "adaptive_rate"
+CONF_MARGIN = "margin"
+CONF_WHITENING = "whitening"
+
+ns = cg.esphome_ns.namespace("cmt2300a_codec")
+CMT2300ACodec = ns.class_("CMT2300ACodec", cg.Component, sx126x.SX126xListener)
+SendAction = ns.class_("SendAction", automation.Action)
+
+WHITENINGS = {
+    "NONE": cg.RawExpression("&CMT2300A_NO_WHITENING"),
+    "PN9": cg.RawExpression("&CMT2300A_PN9"),
+}
+
+CMT2300ACRCMode = cg.global_ns.class_("CMT2300A").enum("CRCMode")
+CRC_MODES = {
+    "NONE": CMT2300ACRCMode.CRC_NONE,
+    "CRC8": CMT2300ACRCMode.CRC_8,
+    "CRC16": CMT2300ACRCMode.CRC_16,
+}
+
+# largest packet the radio sends, cmt2300a_codec.h
+MAX_PACKET_SIZE = 255
+# CMT2300AFragmenter::HEADER_SIZE
+FRAGMENT_HEADER_SIZE = 5
+CRC_SIZES = {"NONE": 0, "CRC8": 1, "CRC16": 2}
+
+
+def encoded_size(length, crc, step_bits):
+    # CMT2300A::encoded_size, the size byte and CRC are encoded with the data
+    return ((length + CRC_SIZES[crc] + 1) * step_bits + 7) // 8
+
+
+def frame_size(length, config):
+    if CONF_ADAPTIVE_RATE in config:
+        # mode byte, every block sent three times at the strongest rate the controller may pick
+        return 1 + encoded_size(length, config[CONF_CRC], 42)
+    return encoded_size(length, config[CONF_CRC], 14)
+
+
+def validate_fragment_size(config):
+    # the encoded fragment, header included, must fit one packet
+    size = config[CONF_FRAGMENT_SIZE]
+    if size > 0 and frame_size(FRAGMENT_HEADER_SIZE + size, config) > MAX_PACKET_SIZE:
+        max_size = 0
+        while frame_size(FRAGMENT_HEADER_SIZE + max_size + 1, config) <= MAX_PACKET_SIZE:
+            max_size += 1
+        raise cv.Invalid(
+            f"fragment_size must be at most {max_size} with this crc and adaptive_rate setting"
+        )
+    if CONF_ON_MESSAGE in config and config[CONF_FRAGMENT_SIZE] == 0:
+        raise cv.Invalid("on_message requires fragment_size")
+    if CONF_ADAPTIVE_RATE in config and config[CONF_SYNC_WINDOW] > 0:
+        raise cv.Invalid("sync_window can't be used with adaptive_rate")
+    if CONF_ADAPTIVE_RATE in config and config[CONF_CRC] == "NONE":
+        # without a CRC uncoded frames always look valid and the rate never steps back up
+        raise cv.Invalid("adaptive_rate requires crc CRC8 or CRC16")
+    return config
+
+
+ADAPTIVE_RATE_SCHEMA = cv.Schema(
+    {
+        # expected goodput gain needed to change the rate
+        cv.Optional(CONF_MARGIN, default="10%"): cv.percentage_int,
+    }
+)
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(CMT2300ACodec),
+            cv.GenerateID(CONF_SX126X_ID): cv.use_id(sx126x.SX126x),
+            cv.Optional(CONF_CRC, default="NONE"): cv.enum(CRC_MODES, upper=True),
+            cv.Optional(CONF_WHITENING, default="NONE"): cv.one_of(
+                *WHITENINGS, upper=True
+            ),
+            cv.Optional(CONF_SYNC_WINDOW, default=0): cv.int_range(0, 64),
+            cv.Optional(CONF_ADAPTIVE_RATE): ADAPTIVE_RATE_SCHEMA,
+            cv.Optional(CONF_FRAGMENT_SIZE, default=0): cv.int_range(0, 255),
+            cv.Optional(
+                CONF_REASSEMBLY_TIMEOUT, default="5s"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_ON_DECODED): automation.validate_automation(single=True),
+            cv.Optional(CONF_ON_MESSAGE): automation.validate_automation(single=True),
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    validate_fragment_size,
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    parent = await cg.get_variable(config[CONF_SX126X_ID])
+    cg.add(var.set_parent(parent))
+    cg.add(parent.register_listener(var))
+    cg.add(var.set_crc(config[CONF_CRC]))
+    cg.add(var.set_whitening(WHITENINGS[config[CONF_WHITENING]]))
+    cg.add(var.set_sync_window(config[CONF_SYNC_WINDOW]))
+    if CONF_ADAPTIVE_RATE in config:
+        adaptive = config[CONF_ADAPTIVE_RATE]
+        cg.add(var.set_adaptive_rate(True))
+        cg.add(var.set_rate_margin(adaptive[CONF_MARGIN]))
+    cg.add(var.set_fragment_size(config[CONF_FRAGMENT_SIZE]))
+    cg.add(var.set_reassembly_timeout(config[CONF_REASSEMBLY_TIMEOUT]))
+    if CONF_ON_DECODED in config:
+        await automation.build_automation(
+            var.get_decoded_trigger(),
+            [
+                (cg.std_vector.template(cg.uint8).operator("const").operator("ref"), "x"),
+                (cg.uint32, "errors"),
+                (cg.bool_, "valid"),
+            ],
+            config[CONF_ON_DECODED],
+        )
+    if CONF_ON_MESSAGE in config:
+        await automation.build_automation(
+            var.get_message_trigger(),
+            [(cg.uint8.operator("const").operator("ptr"), "x"), (cg.size_t, "len")],
+            config[CONF_ON_MESSAGE],
+        )
+
+
+def validate_raw_data(value):
+    if isinstance(value, list):
+        return cv.Schema([cv.hex_uint8_t])(value)
+    raise cv.Invalid("data must be a list of bytes")
+
+
+@automation.register_action(
+    "cmt2300a_codec.send",
+    SendAction,
+    cv.maybe_simple_value(
+        {
+            cv.GenerateID(): cv.use_id(CMT2300ACodec),
+            cv.Required(CONF_DATA): cv.templatable(validate_raw_data),
+        },
+        key=CONF_DATA,
+    ),
+)
+async def send_action_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    data = config[CONF_DATA]
+    if cg.is_template(data):
+        templ = await cg.templatable(data, args, cg.std_vector.template(cg.uint8))
+        cg.add(var.set_data_template(templ))
+    else:
+        cg.add(var.set_data_static(data))
+    return var
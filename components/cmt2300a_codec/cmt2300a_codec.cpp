@@ -0,0 +1,135 @@
+#include "cmt2300a_codec.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace cmt2300a_codec {
+
+static const char *const TAG = "cmt2300a_codec";
+
+void CMT2300ACodec::setup() {
+  this->decoded_.reserve(MAX_PAYLOAD_SIZE);
+  this->encoded_.reserve(MAX_PACKET_SIZE);
+  if (this->fragment_size_ > 0) {
+    this->fragment_.reserve(CMT2300AFragmenter::HEADER_SIZE + this->fragment_size_);
+    this->reassembler_ = std::make_unique<Reassembler>(this->reassembly_timeout_);
+  }
+}
+
+void CMT2300ACodec::dump_config() {
+  ESP_LOGCONFIG(TAG, "CMT2300A Codec:");
+  ESP_LOGCONFIG(TAG, "  CRC Bytes: %u", CMT2300A::crc_size(this->crc_));
+  ESP_LOGCONFIG(TAG, "  Whitening: %s", YESNO(this->whitening_ != &CMT2300A_NO_WHITENING));
+  ESP_LOGCONFIG(TAG, "  Sync Window: %u bits", this->sync_window_);
+  ESP_LOGCONFIG(TAG, "  Adaptive Rate: %s", YESNO(this->adaptive_rate_));
+  if (this->fragment_size_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Fragment Size: %u", this->fragment_size_);
+    ESP_LOGCONFIG(TAG, "  Reassembly Timeout: %u ms", (unsigned) this->reassembly_timeout_);
+  }
+}
+
+void CMT2300ACodec::on_packet(const std::vector<uint8_t> &packet, float rssi, float snr) {
+  size_t len;
+  size_t offset = 0;
+  bool valid;
+  uint32_t errors;
+
+  this->decoded_.resize(MAX_PAYLOAD_SIZE);
+  if (this->adaptive_rate_) {
+    CMT2300AAdaptive::Rate rate;
+    errors = CMT2300AAdaptive::decode(packet.data(), packet.size(), this->decoded_.data(), this->decoded_.size(), len,
+                                      valid, rate, this->crc_, *this->whitening_);
+    if (this->rate_controller_.add(rate, errors, len, valid)) {
+      ESP_LOGD(TAG, "Transmit rate changed to %u, bit error rate %.2e", this->rate_controller_.get_rate(),
+               this->rate_controller_.get_bit_error_rate());
+    }
+  } else if (this->sync_window_ > 0) {
+    errors = CMT2300A::decode_sync(packet.data(), packet.size(), this->decoded_.data(), this->decoded_.size(), len,
+                                   valid, offset, this->sync_window_, this->crc_, *this->whitening_);
+  } else {
+    errors = CMT2300A::decode(packet.data(), packet.size(), this->decoded_.data(), this->decoded_.size(), len, valid,
+                              this->crc_, *this->whitening_);
+  }
+  this->decoded_.resize(len);
+  if (offset != 0) {
+    ESP_LOGV(TAG, "Frame found at bit offset %u", (unsigned) offset);
+  }
+
+  // compiled out, arguments included, below VERBOSE
+  ESP_LOGV(TAG, "Decoded %s, errors %u, valid %d", format_hex(this->decoded_).c_str(), (unsigned) errors, valid);
+
+  this->decoded_trigger_.trigger(this->decoded_, errors, valid);
+
+  if (this->reassembler_ != nullptr && valid) {
+    size_t message_len;
+    const uint8_t *message = this->reassembler_->add(this->decoded_.data(), len, millis(), message_len);
+    if (message != nullptr) {
+      ESP_LOGV(TAG, "Reassembled %u bytes", (unsigned) message_len);
+      this->message_trigger_.trigger(message, message_len);
+    }
+  }
+}
+
+void CMT2300ACodec::send(const std::vector<uint8_t> &data) {
+  if (this->fragment_size_ == 0) {
+    if (this->encoded_size_(data.size()) > MAX_PACKET_SIZE) {
+      ESP_LOGE(TAG, "Payload too large: %u bytes, the encoded frame must fit %u bytes", (unsigned) data.size(),
+               (unsigned) MAX_PACKET_SIZE);
+      return;
+    }
+    this->transmit_(data);
+    return;
+  }
+
+  uint8_t count = CMT2300AFragmenter::count(data.size(), this->fragment_size_);
+  if (count == 0 || data.size() > MAX_MESSAGE_SIZE) {
+    ESP_LOGE(TAG, "Message too large: %u bytes", (unsigned) data.size());
+    return;
+  }
+  uint8_t id = this->message_id_++;
+  for (uint8_t index = 0; index < count; index++) {
+    CMT2300AFragmenter::fragment(data.data(), data.size(), id, this->fragment_size_, index, this->fragment_);
+    this->transmit_(this->fragment_);
+  }
+}
+
+void CMT2300ACodec::send_encoded(const uint8_t *encoded, size_t len) {
+  if (len > MAX_PACKET_SIZE) {
+    ESP_LOGE(TAG, "Frame too large: %u bytes", (unsigned) len);
+    return;
+  }
+  // the buffer is reserved, this is a copy without allocation
+  this->encoded_.assign(encoded, encoded + len);
+  if (this->parent_->transmit_packet(this->encoded_) != sx126x::SX126xError::NONE) {
+    ESP_LOGE(TAG, "Transmit failed");
+  }
+}
+
+size_t CMT2300ACodec::encoded_size_(size_t len) const {
+  if (this->adaptive_rate_) {
+    // transmit_ falls back to uncoded when a coded frame doesn't fit
+    return CMT2300AAdaptive::encoded_size(CMT2300AAdaptive::RATE_UNCODED, len, this->crc_);
+  }
+  return CMT2300A::encoded_size(len, this->crc_);
+}
+
+void CMT2300ACodec::transmit_(const std::vector<uint8_t> &data) {
+  if (this->adaptive_rate_) {
+    // fall back to a weaker rate when the frame wouldn't fit a packet
+    CMT2300AAdaptive::Rate rate = this->rate_controller_.get_rate();
+    while (rate != CMT2300AAdaptive::RATE_UNCODED &&
+           CMT2300AAdaptive::encoded_size(rate, data.size(), this->crc_) > MAX_PACKET_SIZE) {
+      rate = CMT2300AAdaptive::Rate(rate - 1);
+    }
+    CMT2300AAdaptive::encode(rate, data, this->encoded_, this->crc_, *this->whitening_);
+  } else {
+    CMT2300A::encode(data, this->encoded_, this->crc_, *this->whitening_);
+  }
+  if (this->parent_->transmit_packet(this->encoded_) != sx126x::SX126xError::NONE) {
+    ESP_LOGE(TAG, "Transmit failed");
+  }
+}
+
+}  // namespace cmt2300a_codec
+}  // namespace esphome
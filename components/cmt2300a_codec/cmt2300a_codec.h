@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+#include "esphome/components/sx126x/sx126x.h"
+#include "esphome/components/cmt2300a/cmt2300a.h"
+#include "esphome/components/cmt2300a/cmt2300a_adaptive.h"
+#include "esphome/components/cmt2300a/cmt2300a_fragment.h"
+
+namespace esphome {
+namespace cmt2300a_codec {
+
+// the length header is one byte
+static const size_t MAX_PAYLOAD_SIZE = 255;
+static const size_t MAX_MESSAGE_SIZE = 1024;
+// largest packet the radio sends, every encoded frame must fit
+static const size_t MAX_PACKET_SIZE = 255;
+
+using Reassembler = CMT2300AReassembler<4, MAX_MESSAGE_SIZE>;
+
+class CMT2300ACodec : public Component, public sx126x::SX126xListener {
+ public:
+  float get_setup_priority() const override { return setup_priority::DATA; }
+  void setup() override;
+  void dump_config() override;
+
+  void set_parent(sx126x::SX126x *parent) { this->parent_ = parent; }
+  void set_crc(CMT2300A::CRCMode crc) { this->crc_ = crc; }
+  void set_whitening(const CMT2300AWhitening *whitening) { this->whitening_ = whitening; }
+  void set_sync_window(uint8_t sync_window) { this->sync_window_ = sync_window; }
+  void set_adaptive_rate(bool adaptive_rate) { this->adaptive_rate_ = adaptive_rate; }
+  void set_rate_margin(uint8_t margin) { this->rate_controller_.set_margin(margin); }
+  void set_fragment_size(uint8_t fragment_size) { this->fragment_size_ = fragment_size; }
+  void set_reassembly_timeout(uint32_t reassembly_timeout) { this->reassembly_timeout_ = reassembly_timeout; }
+  Trigger<const std::vector<uint8_t> &, uint32_t, bool> *get_decoded_trigger() { return &this->decoded_trigger_; }
+  Trigger<const uint8_t *, size_t> *get_message_trigger() { return &this->message_trigger_; }
+
+  void on_packet(const std::vector<uint8_t> &packet, float rssi, float snr) override;
+  void send(const std::vector<uint8_t> &data);
+  // sends a frame encoded ahead of time, for example with CMT2300A::encode_array
+  void send_encoded(const uint8_t *encoded, size_t len);
+
+ protected:
+  // encoded size of a frame at the weakest rate it may be sent at
+  size_t encoded_size_(size_t len) const;
+  void transmit_(const std::vector<uint8_t> &data);
+
+  sx126x::SX126x *parent_{nullptr};
+  CMT2300A::CRCMode crc_{CMT2300A::CRC_NONE};
+  const CMT2300AWhitening *whitening_{&CMT2300A_NO_WHITENING};
+  // bit offsets searched for the first block, 0 decodes byte aligned
+  uint8_t sync_window_{0};
+  // frames carry a mode byte, the rate follows the bit error rate on received frames
+  bool adaptive_rate_{false};
+  CMT2300ARateController<> rate_controller_;
+  Trigger<const std::vector<uint8_t> &, uint32_t, bool> decoded_trigger_;
+  Trigger<const uint8_t *, size_t> message_trigger_;
+  // data bytes per fragment, 0 sends every payload as a single frame
+  uint8_t fragment_size_{0};
+  uint8_t message_id_{0};
+  uint32_t reassembly_timeout_{5000};
+  std::unique_ptr<Reassembler> reassembler_;
+  std::vector<uint8_t> fragment_;
+  // buffers are reserved once in setup, resizing within the capacity never allocates
+  std::vector<uint8_t> decoded_;
+  std::vector<uint8_t> encoded_;
+};
+
+template<typename... Ts> class SendAction : public Action<Ts...>, public Parented<CMT2300ACodec> {
+ public:
+  void set_data_template(std::function<std::vector<uint8_t>(Ts...)> func) {
+    this->data_func_ = func;
+    this->static_ = false;
+  }
+  void set_data_static(const std::vector<uint8_t> &data) {
+    this->data_static_ = data;
+    this->static_ = true;
+  }
+
+  void play(Ts... x) override {
+    if (this->static_) {
+      this->parent_->send(this->data_static_);
+    } else {
+      this->parent_->send(this->data_func_(x...));
+    }
+  }
+
+ protected:
+  bool static_{false};
+  std::function<std::vector<uint8_t>(Ts...)> data_func_{};
+  std::vector<uint8_t> data_static_{};
+};
+
+}  // namespace cmt2300a_codec
+}  // namespace esphome
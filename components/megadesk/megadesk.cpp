@@ -1,85 +1,235 @@
 #include "megadesk.h"
 #include "esphome/core/log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 
 namespace esphome {
 namespace megadesk {
 
 static const char *TAG = "megadesk";
 
-int32_t MegaDesk::readdigits_() {
-  int r;
-  while ((r = read()) > 0) {
-    if ((r < 0x30) || (r > 0x39)) {
-      // non-digit we're done, return what we have
-      return this->digits_;
+// bytes pulled from the uart per read_array, and per loop() so a large backlog can't stall the main loop
+static const size_t RECV_CHUNK = 32;
+static const size_t RECV_MAX_PER_LOOP = 256;
+
+// memory slots holding the min/max height
+static const uint8_t SLOT_MIN_HEIGHT = 11;
+static const uint8_t SLOT_MAX_HEIGHT = 12;
+
+void MegaDesk::move_to(uint16_t position) {
+  this->target_ = position;
+  this->has_target_ = true;
+  this->enqueue_('=', position, 0, '=');
+}
+
+void MegaDesk::recall(uint8_t slot) { this->enqueue_('L', 0, slot, '='); }
+
+void MegaDesk::set_min_height(uint16_t position) { this->enqueue_('W', position, SLOT_MIN_HEIGHT, 0); }
+
+void MegaDesk::set_max_height(uint16_t position) { this->enqueue_('W', position, SLOT_MAX_HEIGHT, 0); }
+
+void MegaDesk::query() {
+  this->enqueue_('C', 0, 0, '=');
+  this->enqueue_('R', 0, SLOT_MIN_HEIGHT, 'R');
+  this->enqueue_('R', 0, SLOT_MAX_HEIGHT, 'R');
+}
+
+void MegaDesk::enqueue_(uint8_t command, uint16_t position, uint8_t push_addr, uint8_t ack) {
+  if (this->tx_count_ == TX_QUEUE_SIZE) {
+    ESP_LOGW(TAG, "command queue full, dropping '%c'", command);
+    return;
+  }
+  this->tx_queue_[(this->tx_head_ + this->tx_count_) % TX_QUEUE_SIZE] = {command, position, push_addr, ack};
+  ++this->tx_count_;
+  if (!this->tx_inflight_) {
+    this->send_next_();
+  }
+}
+
+void MegaDesk::send_next_() {
+  while (this->tx_count_ > 0) {
+    const Command cmd = this->tx_queue_[this->tx_head_];
+    this->tx_head_ = (this->tx_head_ + 1) % TX_QUEUE_SIZE;
+    --this->tx_count_;
+
+    char buf[16];
+    int len = snprintf(buf, sizeof(buf), "<%c%u,%u\n", cmd.command, cmd.position, cmd.push_addr);
+    ESP_LOGV(TAG, "send '%c' %u %u", cmd.command, cmd.position, cmd.push_addr);
+    write_array(reinterpret_cast<const uint8_t *>(buf), len);
+
+    if (cmd.ack != 0) {
+      // wait for the reply before sending more, so the desk never sees commands back to back
+      this->tx_inflight_ = true;
+      this->tx_sent_ = millis();
+      this->tx_inflight_cmd_ = cmd;
+      return;
     }
-    // it's a digit, add with base10 shift
-    this->digits_ = 10*this->digits_ + (r-0x30);
-    // keep reading...
   }
-  return -1;
+  this->tx_inflight_ = false;
+}
+
+void MegaDesk::ack_(uint8_t command, uint8_t push_addr) {
+  if (!this->tx_inflight_) {
+    return;
+  }
+  const Command &cmd = this->tx_inflight_cmd_;
+  if (command != cmd.ack || (command == 'R' && push_addr != cmd.push_addr)) {
+    return;
+  }
+  this->tx_inflight_ = false;
+  this->send_next_();
 }
 
-void MegaDesk::recvData_() {
-  const int numChars = 2;
-  const int numFields = 4; // read/store all 4 fields for simplicity, use only the last 3.
-  // static variables allows segmented/char-at-a-time decodes
-  static uint16_t receivedBytes[numFields];
-  static uint8_t ndx = 0;
-  int r; // read char/digit
+void MegaDesk::framingError_() {
+  ++this->framing_errors_;
+  ESP_LOGV(TAG, "framing error in state %d (total %u)", this->state_, (unsigned) this->framing_errors_);
+}
 
-  // read 2 chars
-  while ((ndx < numChars) && ((r = read()) != -1))
-  {
-    if ((ndx == 0) && (r != '>'))
-    {
-      // first char is not Tx, keep reading...
-      continue;
+void MegaDesk::recvByte_(uint8_t c) {
+  switch (this->state_) {
+    case RECV_START:
+      // skip until Tx marker
+      if (c == '>') {
+        this->state_ = RECV_COMMAND;
+      }
+      return;
+    case RECV_COMMAND:
+      if (c == '>') {
+        // empty record, the marker starts the next one
+        this->framingError_();
+        return;
+      }
+      this->command_ = c;
+      this->digits_ = 0;
+      this->ndigits_ = 0;
+      this->state_ = RECV_POSITION;
+      return;
+    case RECV_POSITION:
+    case RECV_PUSH_ADDR:
+      break;
+  }
+
+  // ascii digits, any other char ends the field
+  if ((c >= '0') && (c <= '9')) {
+    this->digits_ = 10 * this->digits_ + (c - '0');
+    if (++this->ndigits_ > 5 || this->digits_ > 0xFFFF) {
+      this->framingError_();
+      this->state_ = RECV_START;
     }
-    receivedBytes[ndx] = r;
-    ++ndx;
-  }
-  // read ascii digits
-  while ((ndx >= numChars) && ((r = readdigits_()) != -1)) {
-    receivedBytes[ndx] = r;
-    this->digits_ = 0; // clear
-    if (++ndx == numFields) {
-      // thats all 4 fields. parse/process them now and break-out.
-      parseData_(receivedBytes[1],
-                 receivedBytes[2],
-                 receivedBytes[3]);
-      ndx = 0;
+    return;
+  }
+  if (c == '>') {
+    // truncated record, resync on the new marker
+    this->framingError_();
+    this->state_ = RECV_COMMAND;
+    return;
+  }
+
+  if (this->state_ == RECV_POSITION) {
+    this->position_ = this->digits_;
+    this->digits_ = 0;
+    this->ndigits_ = 0;
+    this->state_ = RECV_PUSH_ADDR;
+  } else if (this->digits_ > 0xFF) {
+    // push_addr is a single byte
+    this->framingError_();
+    this->state_ = RECV_START;
+  } else {
+    this->state_ = RECV_START;
+    this->parseData_(this->command_, this->position_, this->digits_);
+  }
+}
+
+void MegaDesk::publish_(HeightPublisher &pub, float value) {
+  if (pub.sensor == nullptr) {
+    return;
+  }
+  uint32_t now = millis();
+  pub.last_update = now;
+  if (!std::isnan(pub.last_value)) {
+    if (std::fabs(value - pub.last_value) <= this->deadband_ || now - pub.last_publish < this->min_interval_) {
+      // hold back, flushed by loop() once the desk stops streaming
+      pub.pending_value = value;
+      pub.pending = value != pub.last_value;
       return;
     }
   }
+  pub.sensor->publish_state(value);
+  pub.last_value = value;
+  pub.last_publish = now;
+  pub.pending = false;
+}
+
+void MegaDesk::flush_(HeightPublisher &pub, uint32_t now) {
+  if (pub.pending && now - pub.last_update >= this->quiet_timeout_) {
+    pub.sensor->publish_state(pub.pending_value);
+    pub.last_value = pub.pending_value;
+    pub.last_publish = now;
+    pub.pending = false;
+  }
+}
+
+void MegaDesk::feed(const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    this->recvByte_(data[i]);
+  }
 }
 
 void MegaDesk::parseData_(uint8_t command, uint16_t position, uint8_t push_addr) {
+  this->ack_(command, push_addr);
+
   if (command == '=')
   {
-    if (this->raw_height_) {
-      this->raw_height_->publish_state(position);
+    if (this->has_target_ && std::abs(position - this->target_) <= this->target_tolerance_) {
+      this->has_target_ = false;
+      this->target_reached_trigger_.trigger(position);
     }
+    this->publish_(this->raw_height_, position);
   } else if (command == 'R'){
     if (push_addr == 11){
-      if (this->min_height_) {
-        this->min_height_->publish_state(position);
-      }
+      this->publish_(this->min_height_, position);
     } else if (push_addr == 12){
-      if (this->max_height_) {
-        this->max_height_->publish_state(position);
-      }
+      this->publish_(this->max_height_, position);
     }
   }
 }
 
 void MegaDesk::loop() {
-  while (available()) {
-    recvData_();
+  uint8_t buf[RECV_CHUNK];
+  size_t total = 0;
+  int avail;
+  while (total < RECV_MAX_PER_LOOP && (avail = available()) > 0) {
+    size_t len = std::min<size_t>(avail, sizeof(buf));
+    if (!read_array(buf, len)) {
+      break;
+    }
+    this->feed(buf, len);
+    total += len;
+  }
+
+  uint32_t now = millis();
+  if (this->tx_inflight_ && now - this->tx_sent_ >= this->ack_timeout_) {
+    ESP_LOGW(TAG, "no reply to command, sending next");
+    this->send_next_();
   }
+  this->flush_(this->raw_height_, now);
+  this->flush_(this->min_height_, now);
+  this->flush_(this->max_height_, now);
 }
 
 void MegaDesk::dump_config() {
+  ESP_LOGCONFIG(TAG, "MegaDesk:");
+  LOG_SENSOR("  ", "Raw Height", this->raw_height_.sensor);
+  LOG_SENSOR("  ", "Min Height", this->min_height_.sensor);
+  LOG_SENSOR("  ", "Max Height", this->max_height_.sensor);
+  ESP_LOGCONFIG(TAG, "  Deadband: %.1f", this->deadband_);
+  ESP_LOGCONFIG(TAG, "  Min interval: %u ms", (unsigned) this->min_interval_);
+  ESP_LOGCONFIG(TAG, "  Quiet timeout: %u ms", (unsigned) this->quiet_timeout_);
+  ESP_LOGCONFIG(TAG, "  Target tolerance: %u", this->target_tolerance_);
+  ESP_LOGCONFIG(TAG, "  Ack timeout: %u ms", (unsigned) this->ack_timeout_);
+  ESP_LOGCONFIG(TAG, "  Framing errors: %u", (unsigned) this->framing_errors_);
 }
 
 }  // namespace megadesk
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+#include "esphome/core/automation.h"
 #include "esphome/core/component.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/uart/uart.h"
@@ -13,17 +15,118 @@ class MegaDesk : public Component,  public uart::UARTDevice {
   void loop() override;
   void dump_config() override;
 
-  void set_max_height_sensor(sensor::Sensor *sens) { this->max_height_ = sens; }
-  void set_min_height_sensor(sensor::Sensor *sens) { this->min_height_ = sens; }
-  void set_raw_height_sensor(sensor::Sensor *sens) { this->raw_height_ = sens; }
+  void set_max_height_sensor(sensor::Sensor *sens) { this->max_height_.sensor = sens; }
+  void set_min_height_sensor(sensor::Sensor *sens) { this->min_height_.sensor = sens; }
+  void set_raw_height_sensor(sensor::Sensor *sens) { this->raw_height_.sensor = sens; }
+  void set_deadband(float deadband) { this->deadband_ = deadband; }
+  void set_min_interval(uint32_t min_interval) { this->min_interval_ = min_interval; }
+  void set_quiet_timeout(uint32_t quiet_timeout) { this->quiet_timeout_ = quiet_timeout; }
+  void set_target_tolerance(uint16_t tolerance) { this->target_tolerance_ = tolerance; }
+  void set_ack_timeout(uint32_t ack_timeout) { this->ack_timeout_ = ack_timeout; }
+  uint32_t get_framing_errors() const { return this->framing_errors_; }
+  Trigger<uint16_t> *get_target_reached_trigger() { return &this->target_reached_trigger_; }
+
+  // commands sent as '<' command position ',' push_addr '\n'
+  void move_to(uint16_t position);
+  void recall(uint8_t slot);
+  void set_min_height(uint16_t position);
+  void set_max_height(uint16_t position);
+  void query();
+
+  // parses raw uart bytes, records may be split across calls in any way
+  void feed(const uint8_t *data, size_t len);
  protected:
+  // record format: '>' command digits separator digits separator
+  enum RecvState : uint8_t {
+    RECV_START,
+    RECV_COMMAND,
+    RECV_POSITION,
+    RECV_PUSH_ADDR,
+  };
+
+  // last published value per sensor, held back values are flushed after quiet_timeout_
+  struct HeightPublisher {
+    sensor::Sensor *sensor{nullptr};
+    float last_value{NAN};
+    float pending_value{NAN};
+    bool pending{false};
+    uint32_t last_publish{0};
+    uint32_t last_update{0};
+  };
+
+  struct Command {
+    uint8_t command;
+    uint16_t position;
+    uint8_t push_addr;
+    uint8_t ack;  // record command that completes it, 0 if none is expected
+  };
+
+  static const uint8_t TX_QUEUE_SIZE = 8;
+
+  void enqueue_(uint8_t command, uint16_t position, uint8_t push_addr, uint8_t ack);
+  void send_next_();
+  void ack_(uint8_t command, uint8_t push_addr);
+  void publish_(HeightPublisher &pub, float value);
+  void flush_(HeightPublisher &pub, uint32_t now);
   void parseData_(uint8_t command, uint16_t position, uint8_t push_addr);
-  void recvData_();
-  sensor::Sensor *max_height_{nullptr};
-  sensor::Sensor *min_height_{nullptr};
-  sensor::Sensor *raw_height_{nullptr};
-  int32_t readdigits_();
-  uint32_t digits_ = 0;
+  void recvByte_(uint8_t c);
+  void framingError_();
+  HeightPublisher max_height_;
+  HeightPublisher min_height_;
+  HeightPublisher raw_height_;
+  float deadband_{0};
+  uint32_t min_interval_{0};
+  uint32_t quiet_timeout_{500};
+  RecvState state_{RECV_START};
+  uint8_t command_{0};
+  uint8_t ndigits_{0};
+  uint32_t digits_{0};
+  uint16_t position_{0};
+  uint32_t framing_errors_{0};
+  Command tx_queue_[TX_QUEUE_SIZE];
+  uint8_t tx_head_{0};
+  uint8_t tx_count_{0};
+  bool tx_inflight_{false};
+  Command tx_inflight_cmd_;
+  uint32_t tx_sent_{0};
+  uint32_t ack_timeout_{1000};
+  bool has_target_{false};
+  uint16_t target_{0};
+  uint16_t target_tolerance_{1};
+  Trigger<uint16_t> target_reached_trigger_;
+};
+
+template<typename... Ts> class MoveToAction : public Action<Ts...>, public Parented<MegaDesk> {
+ public:
+  TEMPLATABLE_VALUE(uint16_t, position)
+
+  void play(Ts... x) override { this->parent_->move_to(this->position_.value(x...)); }
+};
+
+template<typename... Ts> class RecallAction : public Action<Ts...>, public Parented<MegaDesk> {
+ public:
+  TEMPLATABLE_VALUE(uint8_t, slot)
+
+  void play(Ts... x) override { this->parent_->recall(this->slot_.value(x...)); }
+};
+
+template<typename... Ts> class SetMinHeightAction : public Action<Ts...>, public Parented<MegaDesk> {
+ public:
+  TEMPLATABLE_VALUE(uint16_t, position)
+
+  void play(Ts... x) override { this->parent_->set_min_height(this->position_.value(x...)); }
+};
+
+template<typename... Ts> class SetMaxHeightAction : public Action<Ts...>, public Parented<MegaDesk> {
+ public:
+  TEMPLATABLE_VALUE(uint16_t, position)
+
+  void play(Ts... x) override { this->parent_->set_max_height(this->position_.value(x...)); }
+};
+
+template<typename... Ts> class QueryAction : public Action<Ts...>, public Parented<MegaDesk> {
+ public:
+  void play(Ts... x) override { this->parent_->query(); }
 };
 
 }  // namespace megadesk
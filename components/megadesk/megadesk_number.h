@@ -0,0 +1,22 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_NUMBER
+#include "esphome/components/number/number.h"
+#include "megadesk.h"
+
+namespace esphome {
+namespace megadesk {
+
+// target height, setting it moves the desk
+class MegaDeskHeightNumber : public number::Number, public Parented<MegaDesk> {
+ protected:
+  void control(float value) override {
+    this->parent_->move_to(value);
+    this->publish_state(value);
+  }
+};
+
+}  // namespace megadesk
+}  // namespace esphome
+#endif
@@ -0,0 +1,27 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import number
+from esphome.const import CONF_MAX_VALUE, CONF_MIN_VALUE, CONF_STEP, CONF_ID
+from .sensor import megadesk_ns, MegaDesk, CONF_MEGADESK_ID
+
+DEPENDENCIES = ['megadesk']
+
+MegaDeskHeightNumber = megadesk_ns.class_('MegaDeskHeightNumber', number.Number)
+
+CONFIG_SCHEMA = number.number_schema(MegaDeskHeightNumber).extend(
+    {
+        cv.GenerateID(CONF_MEGADESK_ID): cv.use_id(MegaDesk),
+        cv.Optional(CONF_MIN_VALUE, default=0): cv.float_,
+        cv.Optional(CONF_MAX_VALUE, default=6000): cv.float_,
+        cv.Optional(CONF_STEP, default=1): cv.positive_float,
+    }
+)
+
+async def to_code(config):
+    var = await number.new_number(
+        config,
+        min_value=config[CONF_MIN_VALUE],
+        max_value=config[CONF_MAX_VALUE],
+        step=config[CONF_STEP],
+    )
+    await cg.register_parented(var, config[CONF_MEGADESK_ID])
@@ -8,6 +8,15 @@ from esphome.const import DEVICE_CLASS_DISTANCE, STATE_CLASS_MEASUREMENT, UNIT_M
 CONF_MAX_HEIGHT = "max_height"
 CONF_MIN_HEIGHT = "min_height"
 CONF_RAW_HEIGHT = "raw_height"
+CONF_DEADBAND = "deadband"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_QUIET_TIMEOUT = "quiet_timeout"
+CONF_TARGET_TOLERANCE = "target_tolerance"
+CONF_ACK_TIMEOUT = "ack_timeout"
+CONF_ON_TARGET_REACHED = "on_target_reached"
+CONF_MEGADESK_ID = "megadesk_id"
+CONF_POSITION = "position"
+CONF_SLOT = "slot"
 CODEOWNERS = ["@swoboda1337"]
 
 DEPENDENCIES = ['uart']
@@ -16,6 +25,12 @@ megadesk_ns = cg.esphome_ns.namespace('megadesk')
 
 MegaDesk = megadesk_ns.class_('MegaDesk', cg.Component, sensor.Sensor, uart.UARTDevice)
 
+MoveToAction = megadesk_ns.class_('MoveToAction', automation.Action)
+RecallAction = megadesk_ns.class_('RecallAction', automation.Action)
+SetMinHeightAction = megadesk_ns.class_('SetMinHeightAction', automation.Action)
+SetMaxHeightAction = megadesk_ns.class_('SetMaxHeightAction', automation.Action)
+QueryAction = megadesk_ns.class_('QueryAction', automation.Action)
+
 CONFIG_SCHEMA = uart.UART_DEVICE_SCHEMA.extend(
     {
         cv.GenerateID(): cv.declare_id(MegaDesk),
@@ -37,6 +52,12 @@ CONFIG_SCHEMA = uart.UART_DEVICE_SCHEMA.extend(
             device_class=DEVICE_CLASS_DISTANCE,
             state_class=STATE_CLASS_MEASUREMENT,
         ),
+        cv.Optional(CONF_DEADBAND, default=0): cv.positive_float,
+        cv.Optional(CONF_MIN_INTERVAL, default="0ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_QUIET_TIMEOUT, default="500ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_TARGET_TOLERANCE, default=1): cv.uint16_t,
+        cv.Optional(CONF_ACK_TIMEOUT, default="1s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_ON_TARGET_REACHED): automation.validate_automation(single=True),
     }
 )
 
@@ -44,6 +65,15 @@ async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
+    cg.add(var.set_deadband(config[CONF_DEADBAND]))
+    cg.add(var.set_min_interval(config[CONF_MIN_INTERVAL]))
+    cg.add(var.set_quiet_timeout(config[CONF_QUIET_TIMEOUT]))
+    cg.add(var.set_target_tolerance(config[CONF_TARGET_TOLERANCE]))
+    cg.add(var.set_ack_timeout(config[CONF_ACK_TIMEOUT]))
+    if CONF_ON_TARGET_REACHED in config:
+        await automation.build_automation(
+            var.get_target_reached_trigger(), [(cg.uint16, "x")], config[CONF_ON_TARGET_REACHED]
+        )
     if CONF_MAX_HEIGHT in config:
         sens = await sensor.new_sensor(config[CONF_MAX_HEIGHT])
         cg.add(var.set_max_height_sensor(sens))
@@ -53,3 +83,44 @@ async def to_code(config):
     if CONF_RAW_HEIGHT in config:
         sens = await sensor.new_sensor(config[CONF_RAW_HEIGHT])
         cg.add(var.set_raw_height_sensor(sens))
+
+
+MEGADESK_ACTION_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.use_id(MegaDesk),
+    }
+)
+
+MEGADESK_POSITION_SCHEMA = MEGADESK_ACTION_SCHEMA.extend(
+    {
+        cv.Required(CONF_POSITION): cv.templatable(cv.uint16_t),
+    }
+)
+
+@automation.register_action('megadesk.move_to', MoveToAction, MEGADESK_POSITION_SCHEMA)
+@automation.register_action('megadesk.set_min_height', SetMinHeightAction, MEGADESK_POSITION_SCHEMA)
+@automation.register_action('megadesk.set_max_height', SetMaxHeightAction, MEGADESK_POSITION_SCHEMA)
+async def megadesk_position_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    template_ = await cg.templatable(config[CONF_POSITION], args, cg.uint16)
+    cg.add(var.set_position(template_))
+    return var
+
+@automation.register_action(
+    'megadesk.recall',
+    RecallAction,
+    MEGADESK_ACTION_SCHEMA.extend({cv.Required(CONF_SLOT): cv.templatable(cv.uint8_t)}),
+)
+async def megadesk_recall_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    template_ = await cg.templatable(config[CONF_SLOT], args, cg.uint8)
+    cg.add(var.set_slot(template_))
+    return var
+
+@automation.register_action('megadesk.query', QueryAction, MEGADESK_ACTION_SCHEMA)
+async def megadesk_query_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
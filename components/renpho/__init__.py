@@ -0,0 +1,297 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import esp32_ble_tracker
+from esphome.components import sensor
+from esphome.const import (
+    CONF_ID,
+    CONF_MAX,
+    CONF_MIN,
+    CONF_MODEL,
+    CONF_OFFSET,
+    CONF_MAC_ADDRESS,
+    CONF_WEIGHT,
+    DEVICE_CLASS_DURATION,
+    DEVICE_CLASS_WEIGHT,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_KILOGRAM,
+    UNIT_MILLISECOND,
+)
+from esphome.core import CORE
+
+CODEOWNERS = ["@swoboda1337"]
+DEPENDENCIES = ["esp32_ble_tracker"]
+AUTO_LOAD = ["sensor"]
+
+CONF_STABLE_FRAMES = "stable_frames"
+CONF_TOLERANCE = "tolerance"
+CONF_SESSION_TIMEOUT = "session_timeout"
+CONF_SCALES = "scales"
+CONF_USERS = "users"
+CONF_MIN_WEIGHT = "min_weight"
+CONF_MAX_WEIGHT = "max_weight"
+CONF_SCAN_PROFILE = "scan_profile"
+CONF_IDLE_INTERVAL = "idle_interval"
+CONF_IDLE_WINDOW = "idle_window"
+CONF_WEIGH_IN_INTERVAL = "weigh_in_interval"
+CONF_TIME_TO_READING = "time_to_reading"
+CONF_DETECTION_DELAY = "detection_delay"
+CONF_SCAN_PARAMETERS = "scan_parameters"
+CONF_CONTINUOUS = "continuous"
+CONF_DECODER = "decoder"
+CONF_HEADER = "header"
+CONF_MIN_LENGTH = "min_length"
+CONF_MAC_OFFSET = "mac_offset"
+CONF_STABLE = "stable"
+CONF_SEQUENCE = "sequence"
+CONF_WIDTH = "width"
+CONF_ENDIAN = "endian"
+CONF_MASK = "mask"
+CONF_DIVISOR = "divisor"
+
+MAX_SCALES = 16
+
+renpho_ns = cg.esphome_ns.namespace("renpho")
+Renpho = renpho_ns.class_("Renpho", cg.Component, esp32_ble_tracker.ESPBTDeviceListener)
+RenphoScale = renpho_ns.class_("RenphoScale")
+ScaleDescriptor = renpho_ns.struct("ScaleDescriptor")
+
+# built-in descriptors, see scale_decoder.h
+MODELS = {
+    "ES-CS20M": "ES_CS20M",
+}
+
+ENDIAN = {
+    "little": "FIELD_LITTLE_ENDIAN",
+    "big": "FIELD_BIG_ENDIAN",
+}
+
+FIELD_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_OFFSET): cv.uint8_t,
+        cv.Optional(CONF_WIDTH, default=1): cv.int_range(min=1, max=4),
+        cv.Optional(CONF_ENDIAN, default="little"): cv.one_of(*ENDIAN, lower=True),
+        cv.Optional(CONF_MASK): cv.hex_uint32_t,
+        cv.Optional(CONF_DIVISOR, default=1): cv.int_range(min=1, max=65535),
+        cv.Optional(CONF_MIN, default=0): cv.float_,
+        cv.Optional(CONF_MAX, default=1e9): cv.float_,
+    }
+)
+
+
+def validate_decoder(config):
+    # fields are read in place, so everything must fit in the minimum length
+    length = config[CONF_MIN_LENGTH]
+    if len(config[CONF_HEADER]) > length:
+        raise cv.Invalid(f"{CONF_HEADER} is longer than {CONF_MIN_LENGTH}")
+    if CONF_MAC_OFFSET in config and config[CONF_MAC_OFFSET] + 6 > length:
+        raise cv.Invalid(f"{CONF_MAC_OFFSET} is beyond {CONF_MIN_LENGTH}")
+    for key in (CONF_WEIGHT, CONF_STABLE, CONF_SEQUENCE):
+        if key in config and config[key][CONF_OFFSET] + config[key][CONF_WIDTH] > length:
+            raise cv.Invalid(f"{key} is beyond {CONF_MIN_LENGTH}")
+    return config
+
+
+DECODER_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Required(CONF_HEADER): cv.All(cv.ensure_list(cv.hex_uint8_t), cv.Length(min=1, max=4)),
+            cv.Required(CONF_MIN_LENGTH): cv.uint8_t,
+            cv.Optional(CONF_MAC_OFFSET): cv.int_range(min=0, max=254),
+            cv.Required(CONF_WEIGHT): FIELD_SCHEMA,
+            cv.Optional(CONF_STABLE): FIELD_SCHEMA,
+            cv.Optional(CONF_SEQUENCE): FIELD_SCHEMA,
+        }
+    ),
+    validate_decoder,
+)
+
+
+def field_initializer(field):
+    if field is None:
+        return "{0, 0, esphome::renpho::FIELD_LITTLE_ENDIAN, 0, 1, 0, 0}"
+    mask = field.get(CONF_MASK, (1 << (8 * field[CONF_WIDTH])) - 1)
+    return (
+        f"{{{field[CONF_OFFSET]}, {field[CONF_WIDTH]}, esphome::renpho::{ENDIAN[field[CONF_ENDIAN]]}, "
+        f"0x{mask:X}, {field[CONF_DIVISOR]}, {float(field[CONF_MIN])}f, {float(field[CONF_MAX])}f}}"
+    )
+
+
+def descriptor_initializer(name, config):
+    header = ", ".join(f"0x{b:02X}" for b in config[CONF_HEADER])
+    return (
+        f'{{"{name}", {{{header}}}, {len(config[CONF_HEADER])}, {config[CONF_MIN_LENGTH]}, '
+        f"{config.get(CONF_MAC_OFFSET, 0xFF)}, {field_initializer(config[CONF_WEIGHT])}, "
+        f"{field_initializer(config.get(CONF_STABLE))}, {field_initializer(config.get(CONF_SEQUENCE))}}}"
+    )
+
+
+WEIGHT_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_KILOGRAM,
+    icon="mdi:scale-bathroom",
+    accuracy_decimals=2,
+    device_class=DEVICE_CLASS_WEIGHT,
+    state_class=STATE_CLASS_MEASUREMENT,
+)
+
+
+def validate_user(config):
+    if config[CONF_MIN_WEIGHT] >= config[CONF_MAX_WEIGHT]:
+        raise cv.Invalid(f"{CONF_MIN_WEIGHT} must be less than {CONF_MAX_WEIGHT}")
+    return config
+
+
+USER_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Required(CONF_MIN_WEIGHT): cv.positive_float,
+            cv.Required(CONF_MAX_WEIGHT): cv.positive_float,
+            cv.Required(CONF_WEIGHT): WEIGHT_SCHEMA,
+        }
+    ),
+    validate_user,
+)
+
+SCALE_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(RenphoScale),
+        cv.Required(CONF_MAC_ADDRESS): cv.mac_address,
+        cv.Exclusive(CONF_MODEL, "decoder"): cv.one_of(*MODELS, upper=True),
+        cv.Exclusive(CONF_DECODER, "decoder"): DECODER_SCHEMA,
+        cv.Optional(CONF_WEIGHT): WEIGHT_SCHEMA,
+        cv.Optional(CONF_USERS): cv.ensure_list(USER_SCHEMA),
+    }
+)
+
+
+def validate_scan_profile(config):
+    if config[CONF_IDLE_WINDOW] > config[CONF_IDLE_INTERVAL]:
+        raise cv.Invalid(f"{CONF_IDLE_WINDOW} must not be greater than {CONF_IDLE_INTERVAL}")
+    return config
+
+
+SCAN_PROFILE_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Optional(CONF_IDLE_INTERVAL, default="320ms"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(microseconds=2500), max=cv.TimePeriod(microseconds=10240000)),
+            ),
+            cv.Optional(CONF_IDLE_WINDOW, default="30ms"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(microseconds=2500), max=cv.TimePeriod(microseconds=10240000)),
+            ),
+            cv.Optional(CONF_WEIGH_IN_INTERVAL, default="100ms"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(microseconds=2500), max=cv.TimePeriod(microseconds=10240000)),
+            ),
+        }
+    ),
+    validate_scan_profile,
+)
+
+
+def single_scale(config):
+    # a single scale can be configured at the top level
+    if CONF_MAC_ADDRESS in config:
+        if CONF_SCALES in config:
+            raise cv.Invalid(f"Use either {CONF_MAC_ADDRESS} or {CONF_SCALES}")
+        config = config.copy()
+        scale = {CONF_MAC_ADDRESS: config.pop(CONF_MAC_ADDRESS)}
+        for key in (CONF_MODEL, CONF_DECODER, CONF_WEIGHT, CONF_USERS):
+            if key in config:
+                scale[key] = config.pop(key)
+        config[CONF_SCALES] = [scale]
+    return config
+
+
+def unique_scales(config):
+    macs = [str(scale[CONF_MAC_ADDRESS]) for scale in config[CONF_SCALES]]
+    if len(macs) != len(set(macs)):
+        raise cv.Invalid("Duplicate scale mac_address")
+    return config
+
+
+def detection_delay_needs_profile(config):
+    if CONF_DETECTION_DELAY in config and CONF_SCAN_PROFILE not in config:
+        raise cv.Invalid(f"{CONF_DETECTION_DELAY} requires {CONF_SCAN_PROFILE}")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    single_scale,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(Renpho),
+            cv.Required(CONF_SCALES): cv.All(cv.ensure_list(SCALE_SCHEMA), cv.Length(min=1, max=MAX_SCALES)),
+            cv.Optional(CONF_STABLE_FRAMES, default=1): cv.int_range(min=1, max=255),
+            cv.Optional(CONF_TOLERANCE, default=0.05): cv.positive_float,
+            cv.Optional(CONF_SESSION_TIMEOUT, default="10s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_SCAN_PROFILE): SCAN_PROFILE_SCHEMA,
+            cv.Optional(CONF_TIME_TO_READING): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=0,
+                device_class=DEVICE_CLASS_DURATION,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_DETECTION_DELAY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=0,
+                device_class=DEVICE_CLASS_DURATION,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+        }
+    )
+    .extend(esp32_ble_tracker.ESP_BLE_DEVICE_SCHEMA)
+    .extend(cv.COMPONENT_SCHEMA),
+    unique_scales,
+    detection_delay_needs_profile,
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    await esp32_ble_tracker.register_ble_device(var, config)
+
+    cg.add(var.set_stable_frames(config[CONF_STABLE_FRAMES]))
+    cg.add(var.set_tolerance(config[CONF_TOLERANCE]))
+    cg.add(var.set_session_timeout(config[CONF_SESSION_TIMEOUT]))
+    if CONF_SCAN_PROFILE in config:
+        profile = config[CONF_SCAN_PROFILE]
+        cg.add(
+            var.set_scan_profile(
+                int(profile[CONF_IDLE_INTERVAL].total_milliseconds / 0.625),
+                int(profile[CONF_IDLE_WINDOW].total_milliseconds / 0.625),
+                int(profile[CONF_WEIGH_IN_INTERVAL].total_milliseconds / 0.625),
+            )
+        )
+        # restored when going back to idle, switching profiles otherwise leaves the tracker scanning continuously
+        tracker = CORE.config.get("esp32_ble_tracker", {})
+        cg.add(var.set_tracker_continuous(tracker.get(CONF_SCAN_PARAMETERS, {}).get(CONF_CONTINUOUS, True)))
+    if CONF_DETECTION_DELAY in config:
+        sens = await sensor.new_sensor(config[CONF_DETECTION_DELAY])
+        cg.add(var.set_detection_delay_sensor(sens))
+    if CONF_TIME_TO_READING in config:
+        sens = await sensor.new_sensor(config[CONF_TIME_TO_READING])
+        cg.add(var.set_time_to_reading_sensor(sens))
+
+    for scale_config in config[CONF_SCALES]:
+        scale = cg.new_Pvariable(scale_config[CONF_ID], scale_config[CONF_MAC_ADDRESS].as_hex)
+        if CONF_MODEL in scale_config:
+            cg.add(scale.set_descriptor(cg.RawExpression(f"&esphome::renpho::{MODELS[scale_config[CONF_MODEL]]}")))
+        elif CONF_DECODER in scale_config:
+            # emitted as a constexpr table, evaluated in place over the payload
+            name = f"{scale_config[CONF_ID]}_descriptor"
+            initializer = descriptor_initializer(name, scale_config[CONF_DECODER])
+            cg.add_global(cg.RawStatement(f"static constexpr esphome::renpho::ScaleDescriptor {name}{initializer};"))
+            cg.add(scale.set_descriptor(cg.RawExpression(f"&{name}")))
+        if CONF_WEIGHT in scale_config:
+            sens = await sensor.new_sensor(scale_config[CONF_WEIGHT])
+            cg.add(scale.set_weight_sensor(sens))
+        for user in scale_config.get(CONF_USERS, []):
+            sens = await sensor.new_sensor(user[CONF_WEIGHT])
+            cg.add(scale.add_user(user[CONF_MIN_WEIGHT], user[CONF_MAX_WEIGHT], sens))
+        cg.add(var.add_scale(scale))
@@ -0,0 +1,231 @@
+#include "renpho.h"
+#include "esphome/core/log.h"
+#include <cmath>
+
+#ifdef USE_ESP32
+
+namespace esphome {
+namespace renpho {
+
+static const char *const TAG = "renpho";
+
+static inline size_t hash_address(uint64_t address) {
+  address ^= address >> 24;
+  address *= 0x9E3779B97F4A7C15ULL;
+  return address >> (64 - RENPHO_TABLE_BITS);
+}
+
+static inline uint64_t read_address(const uint8_t *data, bool reversed) {
+  uint64_t address = 0;
+  for (size_t i = 0; i < 6; i++) {
+    address = (address << 8) | data[reversed ? 5 - i : i];
+  }
+  return address;
+}
+
+void Renpho::setup() {
+  if (this->scan_profile_) {
+    // the tracker has not started scanning yet, start with the idle parameters
+    this->parent_->set_scan_interval(this->idle_interval_);
+    this->parent_->set_scan_window(this->idle_window_);
+    this->idle_since_ = millis();
+  }
+}
+
+void Renpho::set_weigh_in_(bool weigh_in) {
+  if (this->weigh_in_ == weigh_in)
+    return;
+  this->weigh_in_ = weigh_in;
+
+  uint32_t interval = weigh_in ? this->weigh_in_interval_ : this->idle_interval_;
+  uint32_t window = weigh_in ? this->weigh_in_interval_ : this->idle_window_;
+  ESP_LOGD(TAG, "%s scan, duty cycle %.1f%%", weigh_in ? "Weigh-in" : "Idle", window * 100.0f / interval);
+
+  uint32_t now = millis();
+  if (weigh_in) {
+    // includes the time until the scale was stepped on, meant for tuning runs that start right after going idle
+    uint32_t delay = now - this->idle_since_;
+    ESP_LOGD(TAG, "First frame %u ms after the idle scan started", (unsigned) delay);
+    if (this->detection_delay_ != nullptr) {
+      this->detection_delay_->publish_state(delay);
+    }
+  } else {
+    this->idle_since_ = now;
+  }
+
+  // the tracker applies new parameters when it restarts the scan. stop_scan() also clears continuous mode, with it
+  // set again the tracker loop starts the next scan once the stop has completed. Idle goes back to the tracker's own
+  // setting, without continuous mode the next scan is left to whoever started this one
+  this->parent_->set_scan_interval(interval);
+  this->parent_->set_scan_window(window);
+  this->parent_->stop_scan();
+  this->parent_->set_scan_continuous(weigh_in || this->tracker_continuous_);
+}
+
+void Renpho::dump_config() {
+  ESP_LOGCONFIG(TAG, "Renpho:");
+  ESP_LOGCONFIG(TAG, "  Stable frames: %u", this->stable_frames_);
+  ESP_LOGCONFIG(TAG, "  Tolerance: %.2f kg", this->tolerance_);
+  ESP_LOGCONFIG(TAG, "  Session timeout: %u ms", (unsigned) this->session_timeout_);
+  if (this->scan_profile_) {
+    ESP_LOGCONFIG(TAG, "  Idle scan: interval %.1f ms, window %.1f ms", this->idle_interval_ * 0.625f,
+                  this->idle_window_ * 0.625f);
+    ESP_LOGCONFIG(TAG, "  Weigh-in scan: continuous, interval %.1f ms", this->weigh_in_interval_ * 0.625f);
+  }
+  LOG_SENSOR("  ", "Time to reading", this->time_to_reading_);
+  LOG_SENSOR("  ", "Detection delay", this->detection_delay_);
+  for (auto *scale : this->table_) {
+    if (scale == nullptr)
+      continue;
+    ESP_LOGCONFIG(TAG, "  Scale %012llX (%s):", (unsigned long long) scale->address_, scale->descriptor_->name);
+    LOG_SENSOR("    ", "Weight", scale->weight_);
+    for (auto &user : scale->users_) {
+      ESP_LOGCONFIG(TAG, "    User %.1f - %.1f kg", user.min_weight, user.max_weight);
+      LOG_SENSOR("      ", "Weight", user.weight);
+    }
+  }
+}
+
+void Renpho::add_scale(RenphoScale *scale) {
+  if (this->scale_count_ >= RENPHO_MAX_SCALES) {
+    ESP_LOGE(TAG, "Too many scales, max %u", (unsigned) RENPHO_MAX_SCALES);
+    return;
+  }
+  size_t i = hash_address(scale->get_address());
+  while (this->table_[i] != nullptr) {
+    i = (i + 1) & (RENPHO_TABLE_SIZE - 1);
+  }
+  this->table_[i] = scale;
+  this->scale_count_++;
+}
+
+RenphoScale *Renpho::find_scale_(uint64_t address) const {
+  size_t i = hash_address(address);
+  while (this->table_[i] != nullptr) {
+    if (this->table_[i]->address_ == address)
+      return this->table_[i];
+    i = (i + 1) & (RENPHO_TABLE_SIZE - 1);
+  }
+  return nullptr;
+}
+
+bool Renpho::parse_device(const esp32_ble_tracker::ESPBTDevice &device) {
+  // cheap reject first, this runs for every advertisement the tracker sees
+  RenphoScale *scale = this->find_scale_(device.address_uint64());
+  if (scale == nullptr)
+    return false;
+
+  bool parsed = false;
+  for (auto &mfr : device.get_manufacturer_datas()) {
+    parsed |= this->parse_data_(scale, mfr.data.data(), mfr.data.size());
+  }
+  return parsed;
+}
+
+bool Renpho::parse_data_(RenphoScale *scale, const uint8_t *data, size_t len) {
+  const ScaleDescriptor &desc = *scale->descriptor_;
+  if (!match_header(desc, data, len))
+    return false;
+
+  // the payload repeats the MAC, either byte order
+  if (desc.mac_offset != NO_MAC) {
+    const uint8_t *mac = data + desc.mac_offset;
+    if (read_address(mac, false) != scale->address_ && read_address(mac, true) != scale->address_) {
+      ESP_LOGV(TAG, "payload MAC does not match %012llX", (unsigned long long) scale->address_);
+      return false;
+    }
+  }
+
+  uint32_t now = millis();
+  uint32_t sequence = field_present(desc.sequence) ? read_raw(desc.sequence, data) : 0;
+  uint32_t raw_weight = read_raw(desc.weight, data);
+  uint32_t flags = field_present(desc.stable) ? read_raw(desc.stable, data) : 1;
+
+  if (scale->seen_ && now - scale->last_seen_ > this->session_timeout_) {
+    ESP_LOGV(TAG, "session ended after %u ms of silence", (unsigned) (now - scale->last_seen_));
+    this->end_session_(scale);
+  }
+
+  // the scale rebroadcasts each frame many times
+  bool duplicate = scale->seen_ && sequence == scale->last_sequence_ && raw_weight == scale->last_raw_weight_ &&
+                   flags == scale->last_flags_;
+
+  scale->seen_ = true;
+  scale->last_seen_ = now;
+  scale->last_sequence_ = sequence;
+  scale->last_raw_weight_ = raw_weight;
+  scale->last_flags_ = flags;
+
+  if (this->scan_profile_) {
+    this->set_weigh_in_(true);
+    // back to idle scanning once every scale has been silent for a session
+    this->set_timeout("weigh_in", this->session_timeout_, [this]() { this->set_weigh_in_(false); });
+  }
+
+  if (duplicate)
+    return true;
+
+  float weight = static_cast<float>(raw_weight) / desc.weight.divisor;
+  bool stable = flags != 0;
+
+  ESP_LOGV(TAG, "seq %u weight %.2f stable %d", (unsigned) sequence, weight, stable);
+
+  if (weight < desc.weight.min) {
+    // stepped off
+    this->end_session_(scale);
+    return true;
+  }
+
+  if (scale->session_start_ == 0) {
+    scale->session_start_ = now;
+  }
+
+  if (!stable || weight > desc.weight.max) {
+    scale->stable_count_ = 0;
+    return true;
+  }
+
+  if (scale->stable_count_ > 0 && std::fabs(weight - scale->candidate_weight_) <= this->tolerance_) {
+    scale->stable_count_++;
+  } else {
+    scale->candidate_weight_ = weight;
+    scale->stable_count_ = 1;
+  }
+
+  if (scale->stable_count_ >= this->stable_frames_ && !scale->published_) {
+    scale->published_ = true;
+    this->publish_(scale, weight);
+    uint32_t elapsed = now - scale->session_start_;
+    ESP_LOGD(TAG, "%012llX first reading after %u ms", (unsigned long long) scale->address_, (unsigned) elapsed);
+    if (this->time_to_reading_ != nullptr) {
+      this->time_to_reading_->publish_state(elapsed);
+    }
+  }
+  return true;
+}
+
+void Renpho::publish_(RenphoScale *scale, float weight) {
+  ESP_LOGD(TAG, "%012llX weight %.2f kg", (unsigned long long) scale->address_, weight);
+  if (scale->weight_ != nullptr) {
+    scale->weight_->publish_state(weight);
+  }
+  for (auto &user : scale->users_) {
+    if (weight >= user.min_weight && weight <= user.max_weight) {
+      if (user.weight != nullptr) {
+        user.weight->publish_state(weight);
+      }
+      break;
+    }
+  }
+}
+
+void Renpho::end_session_(RenphoScale *scale) {
+  scale->stable_count_ = 0;
+  scale->published_ = false;
+  scale->session_start_ = 0;
+}
+
+}  // namespace renpho
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/esp32_ble_tracker/esp32_ble_tracker.h"
+#include "scale_decoder.h"
+
+#ifdef USE_ESP32
+
+namespace esphome {
+namespace renpho {
+
+// open addressing table, kept at most half full
+static const size_t RENPHO_MAX_SCALES = 16;
+static const size_t RENPHO_TABLE_BITS = 5;
+static const size_t RENPHO_TABLE_SIZE = 1 << RENPHO_TABLE_BITS;
+
+struct RenphoUser {
+  float min_weight;
+  float max_weight;
+  sensor::Sensor *weight;
+};
+
+class RenphoScale {
+ public:
+  explicit RenphoScale(uint64_t address) : address_(address) {}
+
+  uint64_t get_address() const { return this->address_; }
+  void set_descriptor(const ScaleDescriptor *descriptor) { this->descriptor_ = descriptor; }
+  void set_weight_sensor(sensor::Sensor *weight) { this->weight_ = weight; }
+  void add_user(float min_weight, float max_weight, sensor::Sensor *weight) {
+    this->users_.push_back({min_weight, max_weight, weight});
+  }
+
+ protected:
+  friend class Renpho;
+
+  uint64_t address_;
+  const ScaleDescriptor *descriptor_{&ES_CS20M};
+  sensor::Sensor *weight_{nullptr};
+  std::vector<RenphoUser> users_;
+
+  // state kept across advertisements, a weigh-in session publishes at most once
+  bool seen_{false};
+  uint32_t last_sequence_{0};
+  uint32_t last_raw_weight_{0};
+  uint32_t last_flags_{0};
+  uint32_t last_seen_{0};
+  uint8_t stable_count_{0};
+  float candidate_weight_{NAN};
+  bool published_{false};
+  uint32_t session_start_{0};
+};
+
+class Renpho : public Component, public esp32_ble_tracker::ESPBTDeviceListener {
+ public:
+  float get_setup_priority() const override { return setup_priority::DATA; }
+  void dump_config() override;
+  bool parse_device(const esp32_ble_tracker::ESPBTDevice &device) override;
+
+  void add_scale(RenphoScale *scale);
+  void set_stable_frames(uint8_t stable_frames) { this->stable_frames_ = stable_frames; }
+  void set_tolerance(float tolerance) { this->tolerance_ = tolerance; }
+  void set_session_timeout(uint32_t session_timeout) { this->session_timeout_ = session_timeout; }
+  // scan interval and window in 0.625 ms units, as esp32_ble_tracker takes them
+  void set_scan_profile(uint32_t idle_interval, uint32_t idle_window, uint32_t weigh_in_interval) {
+    this->scan_profile_ = true;
+    this->idle_interval_ = idle_interval;
+    this->idle_window_ = idle_window;
+    this->weigh_in_interval_ = weigh_in_interval;
+  }
+  // esp32_ble_tracker's own continuous setting, restored when going back to idle
+  void set_tracker_continuous(bool tracker_continuous) { this->tracker_continuous_ = tracker_continuous; }
+  void set_time_to_reading_sensor(sensor::Sensor *time_to_reading) { this->time_to_reading_ = time_to_reading; }
+  void set_detection_delay_sensor(sensor::Sensor *detection_delay) { this->detection_delay_ = detection_delay; }
+  void setup() override;
+
+ protected:
+  RenphoScale *find_scale_(uint64_t address) const;
+  bool parse_data_(RenphoScale *scale, const uint8_t *data, size_t len);
+  void publish_(RenphoScale *scale, float weight);
+  void end_session_(RenphoScale *scale);
+  void set_weigh_in_(bool weigh_in);
+
+  RenphoScale *table_[RENPHO_TABLE_SIZE]{};
+  size_t scale_count_{0};
+  uint8_t stable_frames_{1};
+  float tolerance_{0.05f};
+  uint32_t session_timeout_{10000};
+  sensor::Sensor *time_to_reading_{nullptr};
+  sensor::Sensor *detection_delay_{nullptr};
+
+  // duty-cycled scanning while idle, continuous once a weigh-in starts
+  bool scan_profile_{false};
+  bool weigh_in_{false};
+  uint32_t idle_interval_{0};
+  uint32_t idle_window_{0};
+  uint32_t weigh_in_interval_{0};
+  bool tracker_continuous_{true};
+  uint32_t idle_since_{0};  // millis() when the idle parameters were applied
+};
+
+}  // namespace renpho
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace renpho {
+
+// Declarative manufacturer data decoder for BLE scales. Descriptors are constexpr tables, evaluated in place over the
+// raw payload.
+
+enum FieldEndian : uint8_t {
+  FIELD_LITTLE_ENDIAN,
+  FIELD_BIG_ENDIAN,
+};
+
+// value = (width bytes at offset & mask) / divisor, valid within [min, max], width 0 = field not present
+struct FieldDescriptor {
+  uint8_t offset;
+  uint8_t width;
+  FieldEndian endian;
+  uint32_t mask;
+  uint16_t divisor;
+  float min;
+  float max;
+};
+
+static constexpr uint8_t NO_MAC = 0xFF;
+
+struct ScaleDescriptor {
+  const char *name;
+  uint8_t header[4];
+  uint8_t header_length;
+  uint8_t min_length;
+  uint8_t mac_offset;  // payload repeats the 6 byte MAC here, NO_MAC if it doesn't
+  FieldDescriptor weight;
+  FieldDescriptor stable;    // flag bits, stable when any masked bit is set
+  FieldDescriptor sequence;  // rebroadcasts repeat the same value
+};
+
+constexpr bool field_present(const FieldDescriptor &field) { return field.width > 0; }
+
+constexpr uint32_t read_raw(const FieldDescriptor &field, const uint8_t *data) {
+  uint32_t value = 0;
+  for (uint8_t i = 0; i < field.width; i++) {
+    uint8_t index = field.endian == FIELD_LITTLE_ENDIAN ? field.width - 1 - i : i;
+    value = (value << 8) | data[field.offset + index];
+  }
+  return value & field.mask;
+}
+
+constexpr bool match_header(const ScaleDescriptor &desc, const uint8_t *data, size_t len) {
+  if (len < desc.min_length || len < desc.header_length)
+    return false;
+  for (uint8_t i = 0; i < desc.header_length; i++) {
+    if (data[i] != desc.header[i])
+      return false;
+  }
+  return true;
+}
+
+// Renpho ES-CS20M, QN-Scale AABB passive broadcast
+//   [0:1]   AA BB magic header
+//   [2:7]   MAC address
+//   [8]     Sequence counter
+//   [15]    Flags: bit 0 set = stable reading
+//   [17:18] Weight (little-endian uint16) / 100 = kg
+static constexpr ScaleDescriptor ES_CS20M{
+    "ES-CS20M",
+    {0xAA, 0xBB},
+    2,
+    19,
+    2,
+    {17, 2, FIELD_LITTLE_ENDIAN, 0xFFFF, 100, 0.5f, 300.0f},
+    {15, 1, FIELD_LITTLE_ENDIAN, 0x01, 1, 0, 1},
+    {8, 1, FIELD_LITTLE_ENDIAN, 0xFF, 1, 0, 255},
+};
+
+namespace detail {
+static constexpr uint8_t ES_CS20M_SAMPLE[19]{0xAA, 0xBB, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x07, 0x00,
+                                             0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x4C, 0x1D};
+static_assert(match_header(ES_CS20M, ES_CS20M_SAMPLE, sizeof(ES_CS20M_SAMPLE)), "ES-CS20M header");
+static_assert(read_raw(ES_CS20M.weight, ES_CS20M_SAMPLE) == 7500, "ES-CS20M weight");
+static_assert(read_raw(ES_CS20M.stable, ES_CS20M_SAMPLE) == 1, "ES-CS20M stable flag");
+static_assert(read_raw(ES_CS20M.sequence, ES_CS20M_SAMPLE) == 7, "ES-CS20M sequence");
+}  // namespace detail
+
+}  // namespace renpho
+}  // namespace esphome
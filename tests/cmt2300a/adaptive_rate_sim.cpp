@@ -0,0 +1,146 @@
+// Goodput of the CMT2300A FEC rates over a simulated channel.
+//
+// Two nodes exchange frames in turn over a binary symmetric channel. The bit error rate follows from the SNR per
+// channel bit for noncoherent 2-FSK, p = exp(-SNR / 2) / 2. Each node runs a CMT2300ARateController fed by the
+// frames it receives, as cmt2300a_codec does with adaptive_rate. The fixed rates are sent the way the codec sends
+// them: Hamming as a plain CMT2300A frame, uncoded and repeat behind the adaptive mode byte.
+//
+// Goodput is payload bits delivered intact per bit sent. A frame counts when it decodes valid and matches what was
+// sent, an undetected error counts as lost.
+//
+// The second table drops the SNR during a run, the controllers must step back up from uncoded. Without a CRC an
+// uncoded frame always decodes valid, so they never do.
+//
+//   adaptive_rate_sim [payload bytes] [frames per point]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "cmt2300a/cmt2300a_adaptive.h"
+#include "channel.h"
+
+static const CMT2300A::CRCMode CRC = CMT2300A::CRC_16;
+
+struct Result {
+  uint64_t payload_bits{0};
+  uint64_t sent_bits{0};
+  uint64_t frames[3]{};
+
+  double goodput() const { return this->sent_bits > 0 ? double(this->payload_bits) / this->sent_bits : 0; }
+};
+
+static void random_payload(std::mt19937_64 &rng, std::vector<uint8_t> &payload) {
+  for (auto &byte : payload) {
+    byte = rng();
+  }
+}
+
+static bool delivered(const std::vector<uint8_t> &payload, const uint8_t *decoded, size_t len, bool valid) {
+  return valid && len == payload.size() && std::equal(payload.begin(), payload.end(), decoded);
+}
+
+// one rate for every frame, rate < 0 sends plain CMT2300A frames
+static Result run_fixed(Channel &channel, int rate, size_t payload_size, int frames) {
+  Result result;
+  std::vector<uint8_t> payload(payload_size);
+  std::vector<uint8_t> encoded;
+  uint8_t decoded[255];
+  for (int i = 0; i < frames; i++) {
+    random_payload(channel.rng(), payload);
+    size_t len;
+    bool valid;
+    if (rate < 0) {
+      CMT2300A::encode(payload, encoded, CRC);
+      channel.transmit(encoded);
+      CMT2300A::decode(encoded.data(), encoded.size(), decoded, sizeof(decoded), len, valid, CRC);
+    } else {
+      CMT2300AAdaptive::Rate sent = static_cast<CMT2300AAdaptive::Rate>(rate);
+      CMT2300AAdaptive::Rate received;
+      CMT2300AAdaptive::encode(sent, payload, encoded, CRC);
+      channel.transmit(encoded);
+      CMT2300AAdaptive::decode(encoded.data(), encoded.size(), decoded, sizeof(decoded), len, valid, received, CRC);
+      valid = valid && received == sent;
+    }
+    result.sent_bits += encoded.size() * 8;
+    if (delivered(payload, decoded, len, valid)) {
+      result.payload_bits += payload_size * 8;
+    }
+  }
+  return result;
+}
+
+// two nodes taking turns, each picks its rate from the frames it received
+static Result run_adaptive(Channel &channel, CMT2300ARateController<> (&controllers)[2], size_t payload_size,
+                           int frames, CMT2300A::CRCMode crc = CRC) {
+  Result result;
+  std::vector<uint8_t> payload(payload_size);
+  std::vector<uint8_t> encoded;
+  uint8_t decoded[255];
+  for (int i = 0; i < frames; i++) {
+    CMT2300ARateController<> &sender = controllers[i % 2];
+    CMT2300ARateController<> &receiver = controllers[1 - i % 2];
+    CMT2300AAdaptive::Rate rate = sender.get_rate();
+    result.frames[rate]++;
+
+    random_payload(channel.rng(), payload);
+    CMT2300AAdaptive::encode(rate, payload, encoded, crc);
+    channel.transmit(encoded);
+    size_t len;
+    bool valid;
+    CMT2300AAdaptive::Rate received;
+    uint32_t errors =
+        CMT2300AAdaptive::decode(encoded.data(), encoded.size(), decoded, sizeof(decoded), len, valid, received, crc);
+    receiver.add(received, errors, len, valid);
+
+    result.sent_bits += encoded.size() * 8;
+    if (delivered(payload, decoded, len, valid)) {
+      result.payload_bits += payload_size * 8;
+    }
+  }
+  return result;
+}
+
+int main(int argc, char **argv) {
+  size_t payload_size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 30;
+  int frames = argc > 2 ? std::atoi(argv[2]) : 20000;
+  if (payload_size == 0 || CMT2300AAdaptive::encoded_size(CMT2300AAdaptive::RATE_REPEAT, payload_size, CRC) > 255) {
+    std::fprintf(stderr, "payload must be at least 1 byte and fit a packet at the repeat rate\n");
+    return 1;
+  }
+
+  std::printf("%zu byte payload, CRC-16, %d frames per point\n\n", payload_size, frames);
+  std::printf("SNR dB  bit error  uncoded  hamming  repeat   adaptive  (uncoded/hamming/repeat frames)\n");
+  for (int snr_db = 2; snr_db <= 16; snr_db++) {
+    double snr = std::pow(10.0, snr_db / 10.0);
+    double p = 0.5 * std::exp(-snr / 2);
+    Channel channel(snr_db);
+    channel.set_bit_error_rate(p);
+
+    Result uncoded = run_fixed(channel, CMT2300AAdaptive::RATE_UNCODED, payload_size, frames);
+    Result hamming = run_fixed(channel, -1, payload_size, frames);
+    Result repeat = run_fixed(channel, CMT2300AAdaptive::RATE_REPEAT, payload_size, frames);
+    CMT2300ARateController<> controllers[2];
+    Result adaptive = run_adaptive(channel, controllers, payload_size, frames);
+    std::printf("%6d  %9.2e  %7.3f  %7.3f  %7.3f  %8.3f  (%.0f%%/%.0f%%/%.0f%%)\n", snr_db, p, uncoded.goodput(),
+                hamming.goodput(), repeat.goodput(), adaptive.goodput(), 100.0 * adaptive.frames[0] / frames,
+                100.0 * adaptive.frames[1] / frames, 100.0 * adaptive.frames[2] / frames);
+  }
+
+  std::printf("\nSNR step from 14 dB to 9 dB, goodput after the step\n");
+  std::printf("CRC     adaptive  (uncoded/hamming/repeat frames)\n");
+  const CMT2300A::CRCMode modes[] = {CMT2300A::CRC_NONE, CMT2300A::CRC_16};
+  for (CMT2300A::CRCMode crc : modes) {
+    Channel channel(100);
+    CMT2300ARateController<> controllers[2];
+    channel.set_bit_error_rate(0.5 * std::exp(-std::pow(10.0, 1.4) / 2));
+    run_adaptive(channel, controllers, payload_size, frames, crc);
+    channel.set_bit_error_rate(0.5 * std::exp(-std::pow(10.0, 0.9) / 2));
+    Result after = run_adaptive(channel, controllers, payload_size, frames, crc);
+    std::printf("%-6s  %8.3f  (%.0f%%/%.0f%%/%.0f%%)\n", crc == CMT2300A::CRC_NONE ? "none" : "CRC-16", after.goodput(),
+                100.0 * after.frames[0] / frames, 100.0 * after.frames[1] / frames,
+                100.0 * after.frames[2] / frames);
+  }
+  return 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Binary symmetric channel, flips every bit independently with the bit error rate.
+class Channel {
+ public:
+  explicit Channel(uint64_t seed) : rng_(seed) {}
+
+  void set_bit_error_rate(double p) { this->p_ = p; }
+
+  void transmit(std::vector<uint8_t> &bits) {
+    if (this->p_ <= 0) {
+      return;
+    }
+    // distance to the next flipped bit
+    std::geometric_distribution<size_t> gap(this->p_);
+    size_t total = bits.size() * 8;
+    for (size_t bit = gap(this->rng_); bit < total; bit += 1 + gap(this->rng_)) {
+      bits[bit / 8] ^= 0x80 >> (bit % 8);
+    }
+  }
+
+  std::mt19937_64 &rng() { return this->rng_; }
+
+ protected:
+  std::mt19937_64 rng_;
+  double p_{0};
+};
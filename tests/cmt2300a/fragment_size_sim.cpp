@@ -0,0 +1,140 @@
+// Goodput of fragmented messages against fragment size over a simulated channel.
+//
+// Every fragment goes through CMT2300AFragmenter, is encoded as a CMT2300A frame with a CRC-16, sent over a binary
+// symmetric channel, decoded and handed to a CMT2300AReassembler, as cmt2300a_codec does with fragment_size. Each
+// packet also costs the radio's preamble and sync word, which larger fragments amortize and smaller ones lose less
+// often to bit errors.
+//
+// Goodput is message bits delivered intact per bit on air. A single pass sends every fragment once and loses the
+// message with any fragment. With resends the sender repeats the fragments that didn't arrive until the message is
+// complete, as an application level acknowledgement would, with the reassembler dropping the duplicates.
+//
+//   fragment_size_sim [message bytes] [messages per point] [preamble and sync bytes]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "cmt2300a/cmt2300a.h"
+#include "cmt2300a/cmt2300a_fragment.h"
+#include "channel.h"
+
+static const CMT2300A::CRCMode CRC = CMT2300A::CRC_16;
+
+// the largest fragment whose encoded frame fits the radio's 255 byte packet
+static const uint8_t MAX_FRAGMENT_SIZE = 137;
+static_assert(CMT2300A::encoded_size(CMT2300AFragmenter::HEADER_SIZE + MAX_FRAGMENT_SIZE, CRC) <= 255,
+              "largest fragment fits a packet");
+static_assert(CMT2300A::encoded_size(CMT2300AFragmenter::HEADER_SIZE + MAX_FRAGMENT_SIZE + 1, CRC) > 255,
+              "largest fragment");
+
+struct Result {
+  uint64_t message_bits{0};
+  uint64_t air_bits{0};
+  uint32_t delivered{0};
+
+  double goodput() const { return this->air_bits > 0 ? double(this->message_bits) / this->air_bits : 0; }
+};
+
+class Link {
+ public:
+  Link(Channel &channel, size_t overhead) : channel_(channel), overhead_(overhead) {}
+
+  // one fragment over the air, true if it decoded valid
+  bool send(const std::vector<uint8_t> &fragment, uint32_t now, Result &result, const std::vector<uint8_t> &message) {
+    CMT2300A::encode(fragment, this->encoded_, CRC);
+    result.air_bits += (this->encoded_.size() + this->overhead_) * 8;
+    this->channel_.transmit(this->encoded_);
+    size_t len, message_len;
+    bool valid;
+    CMT2300A::decode(this->encoded_.data(), this->encoded_.size(), this->decoded_, sizeof(this->decoded_), len, valid,
+                     CRC);
+    if (!valid) {
+      return false;
+    }
+    const uint8_t *completed = this->reassembler_.add(this->decoded_, len, now, message_len);
+    if (completed != nullptr && message_len == message.size() &&
+        std::equal(message.begin(), message.end(), completed)) {
+      result.message_bits += message.size() * 8;
+      result.delivered++;
+    }
+    return true;
+  }
+
+ protected:
+  Channel &channel_;
+  size_t overhead_;
+  std::vector<uint8_t> encoded_;
+  uint8_t decoded_[255];
+  CMT2300AReassembler<> reassembler_;
+};
+
+static Result run(Channel &channel, size_t overhead, uint8_t size, size_t message_size, int messages,
+                  bool resend) {
+  Result result;
+  Link link(channel, overhead);
+  std::vector<uint8_t> message(message_size);
+  std::vector<uint8_t> fragment;
+  uint8_t count = CMT2300AFragmenter::count(message_size, size);
+  std::vector<bool> arrived(count);
+  uint32_t now = 0;
+  for (int i = 0; i < messages; i++) {
+    for (auto &byte : message) {
+      byte = channel.rng()();
+    }
+    uint8_t id = i;
+    std::fill(arrived.begin(), arrived.end(), false);
+    size_t missing = count;
+    // a message that needs more than 100 rounds is given up
+    for (int round = 0; missing > 0 && round < (resend ? 100 : 1); round++) {
+      for (uint8_t index = 0; index < count; index++) {
+        if (arrived[index]) {
+          continue;
+        }
+        CMT2300AFragmenter::fragment(message.data(), message.size(), id, size, index, fragment);
+        if (link.send(fragment, now++, result, message)) {
+          arrived[index] = true;
+          missing--;
+        }
+      }
+    }
+    // the next message may reuse the ID, let the reassembler time this one out
+    now += 10000;
+  }
+  return result;
+}
+
+int main(int argc, char **argv) {
+  size_t message_size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+  int messages = argc > 2 ? std::atoi(argv[2]) : 200;
+  size_t overhead = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 8;
+  if (message_size == 0 || message_size > 1024 || CMT2300AFragmenter::count(message_size, 8) == 0) {
+    std::fprintf(stderr, "message must be 1 to 1024 bytes\n");
+    return 1;
+  }
+
+  const uint8_t sizes[] = {8, 16, 24, 32, 48, 64, 96, 128, MAX_FRAGMENT_SIZE};
+  const double bers[] = {1e-4, 3e-4, 1e-3, 3e-3, 1e-2, 2e-2, 3e-2, 5e-2};
+
+  std::printf("%zu byte messages, CRC-16, %zu bytes of preamble and sync per packet, %d messages per point\n",
+              message_size, overhead, messages);
+  for (bool resend : {false, true}) {
+    std::printf("\n%s, goodput by fragment size\n", resend ? "Resending lost fragments" : "Single pass");
+    std::printf("bit error ");
+    for (uint8_t size : sizes) {
+      std::printf("%7u", (unsigned) size);
+    }
+    std::printf("\n");
+    for (double ber : bers) {
+      std::printf("%9.0e ", ber);
+      for (uint8_t size : sizes) {
+        Channel channel(static_cast<uint64_t>(ber * 1e6) * 256 + size);
+        channel.set_bit_error_rate(ber);
+        Result result = run(channel, overhead, size, message_size, messages, resend);
+        std::printf("%7.3f", result.goodput());
+      }
+      std::printf("\n");
+    }
+  }
+  return 0;
+}
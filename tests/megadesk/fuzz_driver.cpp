@@ -0,0 +1,43 @@
+// Runs the fuzz entry point without libFuzzer: on the files given as arguments, or on random
+// inputs built from record fragments.
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static void run(const std::string &input) {
+  LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+      std::ifstream in(argv[i], std::ios::binary);
+      run(std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()));
+    }
+    return 0;
+  }
+
+  const std::string fragments[] = {">", "=", "R", "C", "L", "W", ",", "\n", "\r", {'\0'},
+                                   "0", "9", "11", "12", "255", "256", "1000", "65535", "65536", "99999"};
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<size_t> pick(0, std::size(fragments) - 1);
+  std::uniform_int_distribution<int> length(0, 200);
+  std::uniform_int_distribution<int> byte(0, 255);
+  for (int i = 0; i < 20000; i++) {
+    std::string input(1, static_cast<char>(byte(rng)));
+    for (int n = length(rng); n > 0; n--) {
+      if (n % 17 == 0)
+        input += static_cast<char>(byte(rng));
+      else
+        input += fragments[pick(rng)];
+    }
+    run(input);
+  }
+  std::printf("20000 inputs\n");
+  return 0;
+}
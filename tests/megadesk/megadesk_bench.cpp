@@ -0,0 +1,39 @@
+// Records per second through the MegaDesk parser, fed the way loop() sees the UART.
+
+#include <chrono>
+#include <cstdio>
+#include "megadesk_harness.h"
+
+using esphome::megadesk::TestDesk;
+
+static std::string make_stream(size_t records) {
+  std::string stream;
+  for (size_t i = 0; i < records; i++) {
+    if (i % 50 == 49) {
+      stream += ">R" + std::to_string(700 + i % 7) + ",11\n";
+    } else {
+      stream += ">=" + std::to_string(1000 + (i / 4) % 500) + ",0\n";
+    }
+  }
+  return stream;
+}
+
+static void bench(const char *name, const std::string &stream, size_t records, size_t chunk) {
+  TestDesk t;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+    t.receive(stream.substr(pos, chunk));
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::printf("%-24s %10.0f records/s (%zu records, %zu bytes per loop)\n", name, records / elapsed.count(), records,
+              chunk);
+}
+
+int main() {
+  const size_t records = 1000000;
+  std::string stream = make_stream(records);
+  bench("byte per loop", stream, records, 1);
+  bench("uart fifo (32 bytes)", stream, records, 32);
+  bench("max per loop (256 bytes)", stream, records, 256);
+  return 0;
+}
@@ -0,0 +1,31 @@
+// libFuzzer entry point for the MegaDesk record parser.
+//
+// The first input byte picks the UART chunk size, the rest is received by the desk.
+
+#include <cstdlib>
+#include "megadesk_harness.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (size == 0)
+    return 0;
+  esphome::megadesk::TestDesk t;
+  size_t chunk = 1 + data[0] % 64;
+  data++;
+  size--;
+
+  uint32_t errors = 0;
+  for (size_t pos = 0; pos < size; pos += chunk) {
+    t.receive(std::string(reinterpret_cast<const char *>(data) + pos, std::min(chunk, size - pos)));
+    // framing errors only ever grow, and at most by one per byte
+    uint32_t now = t.desk.get_framing_errors();
+    if (now < errors || now - errors > chunk)
+      std::abort();
+    errors = now;
+  }
+  // published heights come from fields of at most 16 bits
+  for (const auto *sens : {&t.raw, &t.min, &t.max}) {
+    if (sens->state < 0 || sens->state > 0xFFFF)
+      std::abort();
+  }
+  return 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include "megadesk/megadesk.h"
+
+namespace esphome {
+namespace megadesk {
+
+// A MegaDesk with its three height sensors, publishing into sensor::published.
+struct TestDesk {
+  TestDesk() {
+    sensor::published.clear();
+    fake_millis = 0;
+    this->desk.set_raw_height_sensor(&this->raw);
+    this->desk.set_min_height_sensor(&this->min);
+    this->desk.set_max_height_sensor(&this->max);
+  }
+
+  // queues bytes on the fake UART and runs loop() as the main loop would
+  void receive(const std::string &bytes) {
+    this->desk.inject(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size());
+    this->desk.loop();
+  }
+
+  // receives bytes split into random chunks of 1..max_chunk, with empty loop() calls in between
+  void replay(const std::string &bytes, std::mt19937 &rng, size_t max_chunk) {
+    std::uniform_int_distribution<size_t> chunk(1, max_chunk);
+    std::uniform_int_distribution<int> idle(0, 3);
+    size_t pos = 0;
+    while (pos < bytes.size()) {
+      size_t len = std::min(chunk(rng), bytes.size() - pos);
+      this->receive(bytes.substr(pos, len));
+      pos += len;
+      for (int i = idle(rng); i > 0; i--)
+        this->desk.loop();
+    }
+  }
+
+  sensor::Sensor raw{"raw"};
+  sensor::Sensor min{"min"};
+  sensor::Sensor max{"max"};
+  MegaDesk desk;
+};
+
+}  // namespace megadesk
+}  // namespace esphome
@@ -0,0 +1,152 @@
+// Replays captured controller output through MegaDesk and checks what it publishes.
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+#include "megadesk_harness.h"
+
+using esphome::megadesk::TestDesk;
+
+static int failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+    } \
+  } while (0)
+
+static std::string read_file(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    std::fprintf(stderr, "cannot open %s\n", path.c_str());
+    failures++;
+  }
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static std::vector<std::string> split_lines(const std::string &text) {
+  std::vector<std::string> lines;
+  std::istringstream in(text);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty())
+      lines.push_back(line);
+  }
+  return lines;
+}
+
+static bool check_sequence(const char *what, const std::vector<std::string> &got,
+                           const std::vector<std::string> &want) {
+  if (got == want)
+    return true;
+  std::fprintf(stderr, "%s: published sequence differs\n", what);
+  for (size_t i = 0; i < std::max(got.size(), want.size()); i++) {
+    std::fprintf(stderr, "  %-20s %s\n", i < want.size() ? want[i].c_str() : "-", i < got.size() ? got[i].c_str() : "-");
+  }
+  failures++;
+  return false;
+}
+
+// the capture must publish the same sequence however the UART splits it
+static void test_capture(const std::string &name) {
+  std::string capture = read_file(std::string(CAPTURE_DIR) + "/" + name + ".log");
+  std::vector<std::string> want = split_lines(read_file(std::string(CAPTURE_DIR) + "/" + name + ".expected"));
+
+  for (unsigned seed = 0; seed < 200; seed++) {
+    std::mt19937 rng(seed);
+    size_t max_chunk = 1 + seed % 64;
+    TestDesk t;
+    t.replay(capture, rng, max_chunk);
+    std::vector<std::string> got = esphome::sensor::published;
+    got.push_back("framing_errors " + std::to_string(t.desk.get_framing_errors()));
+    std::string what = name + " seed " + std::to_string(seed);
+    if (!check_sequence(what.c_str(), got, want))
+      return;
+  }
+}
+
+static void test_nul_ends_field() {
+  TestDesk t;
+  t.receive(std::string(">=12\0", 5));
+  t.receive("3,0\n");
+  check_sequence("nul", esphome::sensor::published, {"raw 12"});
+  CHECK(t.desk.get_framing_errors() == 0);
+}
+
+static void test_field_limits() {
+  TestDesk t;
+  t.receive(">R700,255\n");
+  CHECK(t.desk.get_framing_errors() == 0);
+  t.receive(">R700,267\n");
+  CHECK(t.desk.get_framing_errors() == 1);
+  t.receive(">=65536,0\n");
+  CHECK(t.desk.get_framing_errors() == 2);
+  t.receive(">=65535,0\n");
+  check_sequence("limits", esphome::sensor::published, {"raw 65535"});
+}
+
+static void test_resync() {
+  TestDesk t;
+  t.receive(">>=1000,0\n>=10>=1001,0\n");
+  check_sequence("resync", esphome::sensor::published, {"raw 1000", "raw 1001"});
+  CHECK(t.desk.get_framing_errors() == 2);
+}
+
+// commands expecting a reply are held until the desk answers
+static void test_command_ack() {
+  TestDesk t;
+  t.desk.query();
+  CHECK(t.desk.take_written() == "<C0,0\n");
+  t.receive(">=1000,0\n");
+  CHECK(t.desk.take_written() == "<R0,11\n");
+  t.receive(">R700,12\n");
+  CHECK(t.desk.take_written().empty());
+  t.receive(">R700,11\n");
+  CHECK(t.desk.take_written() == "<R0,12\n");
+  t.receive(">R1200,12\n");
+  CHECK(t.desk.take_written().empty());
+  check_sequence("ack", esphome::sensor::published, {"raw 1000", "max 700", "min 700", "max 1200"});
+}
+
+static void test_target_reached() {
+  TestDesk t;
+  std::vector<uint16_t> reached;
+  t.desk.get_target_reached_trigger()->callback = [&reached](uint16_t position) { reached.push_back(position); };
+  t.desk.move_to(1010);
+  t.receive(">=1000,0\n>=1005,0\n>=1009,0\n>=1010,0\n");
+  CHECK(reached.size() == 1 && reached[0] == 1009);
+}
+
+// values inside the deadband are held back and published once the desk goes quiet
+static void test_quiet_flush() {
+  TestDesk t;
+  t.desk.set_deadband(5);
+  t.receive(">=1000,0\n>=1003,0\n");
+  check_sequence("deadband", esphome::sensor::published, {"raw 1000"});
+  esphome::fake_millis = 499;
+  t.desk.loop();
+  check_sequence("deadband", esphome::sensor::published, {"raw 1000"});
+  esphome::fake_millis = 500;
+  t.desk.loop();
+  check_sequence("deadband", esphome::sensor::published, {"raw 1000", "raw 1003"});
+}
+
+int main() {
+  test_capture("move_and_read");
+  test_nul_ends_field();
+  test_field_limits();
+  test_resync();
+  test_command_ack();
+  test_target_reached();
+  test_quiet_flush();
+  if (failures != 0) {
+    std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  std::printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace sensor {
+
+// every publish of every sensor, in order, as "<name> <value>"
+inline std::vector<std::string> published;
+
+class Sensor {
+ public:
+  explicit Sensor(const char *name) : name_(name) {}
+
+  void publish_state(float state) {
+    this->state = state;
+    published.push_back(this->name_ + " " + std::to_string(static_cast<long>(state)));
+  }
+
+  float state{0.0f};
+
+ protected:
+  std::string name_;
+};
+
+}  // namespace sensor
+}  // namespace esphome
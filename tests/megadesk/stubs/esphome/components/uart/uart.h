@@ -0,0 +1,40 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+namespace esphome {
+namespace uart {
+
+// Stands in for the UART: the test queues received bytes, written bytes are collected.
+class UARTDevice {
+ public:
+  int available() { return static_cast<int>(this->rx_.size()); }
+
+  bool read_array(uint8_t *data, size_t len) {
+    if (len > this->rx_.size())
+      return false;
+    std::copy_n(this->rx_.begin(), len, data);
+    this->rx_.erase(this->rx_.begin(), this->rx_.begin() + len);
+    return true;
+  }
+
+  void write_array(const uint8_t *data, size_t len) { this->tx_.append(reinterpret_cast<const char *>(data), len); }
+
+  void inject(const uint8_t *data, size_t len) { this->rx_.insert(this->rx_.end(), data, data + len); }
+  std::string take_written() {
+    std::string tx;
+    tx.swap(this->tx_);
+    return tx;
+  }
+
+ protected:
+  std::deque<uint8_t> rx_;
+  std::string tx_;
+};
+
+}  // namespace uart
+}  // namespace esphome
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+// time is driven by the test
+inline uint32_t fake_millis = 0;
+
+inline uint32_t millis() { return fake_millis; }
+
+}  // namespace esphome
@@ -0,0 +1,66 @@
+// Advertisements per second through Renpho::parse_device, replaying the captures with and without other BLE traffic.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include "renpho_harness.h"
+
+using esphome::renpho::Advertisement;
+using esphome::renpho::load_capture;
+using esphome::renpho::TestScale;
+using esphome::sensor::published;
+
+// the capture back to back, each copy after the session of the previous one timed out, with `others` advertisements
+// from unknown devices after every scale frame
+static std::vector<Advertisement> make_stream(const std::vector<Advertisement> &capture, size_t copies,
+                                              size_t others) {
+  std::mt19937 rng(1);
+  std::vector<Advertisement> stream;
+  uint32_t offset = 0;
+  for (size_t copy = 0; copy < copies; copy++) {
+    for (auto &adv : capture) {
+      Advertisement shifted = adv;
+      shifted.ms += offset;
+      stream.push_back(shifted);
+      for (size_t i = 0; i < others; i++) {
+        Advertisement other{shifted.ms, (uint64_t(rng()) << 16 | (rng() & 0xFFFF)) & 0xFFFFFFFFFFFFULL, {}};
+        other.data.resize(8 + rng() % 20);
+        for (auto &b : other.data)
+          b = rng();
+        stream.push_back(other);
+      }
+    }
+    offset += capture.back().ms + 20000;
+  }
+  return stream;
+}
+
+static void bench(const char *name, const std::vector<Advertisement> &stream) {
+  TestScale t;
+  auto start = std::chrono::steady_clock::now();
+  size_t parsed = t.replay(stream);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  size_t readings = std::count_if(published.begin(), published.end(),
+                                  [](const std::string &p) { return p.rfind("weight ", 0) == 0; });
+  std::printf("%-28s %10.0f records/s (%zu records, %zu scale frames, %zu readings)\n", name,
+              stream.size() / elapsed.count(), stream.size(), parsed, readings);
+}
+
+int main() {
+  auto capture = load_capture(std::string(CAPTURE_DIR) + "/weigh_ins.log");
+  if (capture.empty())
+    return 1;
+
+  // decode results of one pass, what replay_test checks against weigh_ins.expected
+  TestScale once;
+  size_t parsed = once.replay(capture);
+  std::printf("weigh_ins.log: %zu advertisements, %zu scale frames\n", capture.size(), parsed);
+  for (auto &p : published)
+    std::printf("  %s\n", p.c_str());
+
+  const size_t copies = 20000;
+  bench("scale only", make_stream(capture, copies, 0));
+  bench("with 9 other devices", make_stream(capture, copies / 10, 9));
+  return 0;
+}
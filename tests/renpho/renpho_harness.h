@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "renpho/renpho.h"
+
+namespace esphome {
+namespace renpho {
+
+static const uint64_t TEST_SCALE_ADDRESS = 0x112233445566ULL;
+
+// one line of a capture: "<ms> <advertiser MAC> <manufacturer data in hex>"
+struct Advertisement {
+  uint32_t ms;
+  uint64_t address;
+  std::vector<uint8_t> data;
+};
+
+inline std::vector<Advertisement> load_capture(const std::string &path) {
+  std::vector<Advertisement> capture;
+  std::ifstream in(path);
+  if (!in) {
+    std::fprintf(stderr, "cannot open %s\n", path.c_str());
+    return capture;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::istringstream fields(line);
+    std::string mac, hex;
+    Advertisement adv{};
+    fields >> adv.ms >> mac >> hex;
+    for (size_t i = 0; i < mac.size(); i += 3)
+      adv.address = (adv.address << 8) | std::stoul(mac.substr(i, 2), nullptr, 16);
+    for (size_t i = 0; i + 1 < hex.size(); i += 2)
+      adv.data.push_back(std::stoul(hex.substr(i, 2), nullptr, 16));
+    capture.push_back(adv);
+  }
+  return capture;
+}
+
+// A scan profile with one ES-CS20M and two users, publishing into sensor::published.
+struct TestScale {
+  explicit TestScale(bool tracker_continuous = true) {
+    sensor::published.clear();
+    fake_millis = 0;
+    this->scale.set_weight_sensor(&this->weight);
+    this->scale.add_user(70.0f, 80.0f, &this->alice);
+    this->scale.add_user(55.0f, 65.0f, &this->bob);
+    this->renpho.add_scale(&this->scale);
+    this->renpho.set_parent(&this->tracker);
+    this->renpho.set_stable_frames(3);
+    this->renpho.set_scan_profile(512, 48, 160);
+    this->renpho.set_tracker_continuous(tracker_continuous);
+    this->renpho.set_time_to_reading_sensor(&this->time_to_reading);
+    this->renpho.set_detection_delay_sensor(&this->detection_delay);
+    this->renpho.setup();
+  }
+
+  // moves the clock forward and runs what the scheduler would have run by then
+  void advance_to(uint32_t ms) { this->renpho.advance_to(ms); }
+
+  bool receive(const Advertisement &adv) {
+    this->advance_to(adv.ms);
+    this->device.address = adv.address;
+    this->device.manufacturer_datas.assign(1, {{0xBBAA}, adv.data});
+    return this->renpho.parse_device(this->device);
+  }
+
+  // the whole capture, then enough silence for the session to end
+  size_t replay(const std::vector<Advertisement> &capture) {
+    size_t parsed = 0;
+    for (auto &adv : capture)
+      parsed += this->receive(adv);
+    if (!capture.empty())
+      this->advance_to(capture.back().ms + 10001);
+    return parsed;
+  }
+
+  sensor::Sensor weight{"weight"};
+  sensor::Sensor alice{"alice"};
+  sensor::Sensor bob{"bob"};
+  sensor::Sensor time_to_reading{"time_to_reading"};
+  sensor::Sensor detection_delay{"detection_delay"};
+  esp32_ble_tracker::ESP32BLETracker tracker;
+  esp32_ble_tracker::ESPBTDevice device;
+  RenphoScale scale{TEST_SCALE_ADDRESS};
+  Renpho renpho;
+};
+
+}  // namespace renpho
+}  // namespace esphome
@@ -0,0 +1,160 @@
+// Replays captured scale advertisements through Renpho and checks what it publishes.
+
+#include <algorithm>
+#include <cstdio>
+#include "renpho_harness.h"
+
+using esphome::renpho::Advertisement;
+using esphome::renpho::load_capture;
+using esphome::renpho::TEST_SCALE_ADDRESS;
+using esphome::renpho::TestScale;
+using esphome::sensor::published;
+
+static int failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+    } \
+  } while (0)
+
+static std::vector<std::string> read_lines(const std::string &path) {
+  std::vector<std::string> lines;
+  std::ifstream in(path);
+  if (!in) {
+    std::fprintf(stderr, "cannot open %s\n", path.c_str());
+    failures++;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty())
+      lines.push_back(line);
+  }
+  return lines;
+}
+
+static bool check_sequence(const char *what, const std::vector<std::string> &got,
+                           const std::vector<std::string> &want) {
+  if (got == want)
+    return true;
+  std::fprintf(stderr, "%s: published sequence differs\n", what);
+  for (size_t i = 0; i < std::max(got.size(), want.size()); i++) {
+    std::fprintf(stderr, "  %-28s %s\n", i < want.size() ? want[i].c_str() : "-",
+                 i < got.size() ? got[i].c_str() : "-");
+  }
+  failures++;
+  return false;
+}
+
+static std::vector<uint8_t> es_cs20m_frame(uint8_t sequence, float weight, bool stable, bool reversed_mac = false) {
+  std::vector<uint8_t> frame{0xAA, 0xBB};
+  for (int i = 0; i < 6; i++) {
+    int shift = reversed_mac ? 8 * i : 40 - 8 * i;
+    frame.push_back(TEST_SCALE_ADDRESS >> shift);
+  }
+  frame.push_back(sequence);
+  frame.resize(15, 0);
+  frame.push_back(stable ? 1 : 0);
+  frame.push_back(0);
+  uint16_t raw = static_cast<uint16_t>(weight * 100.0f + 0.5f);
+  frame.push_back(raw & 0xFF);
+  frame.push_back(raw >> 8);
+  return frame;
+}
+
+// the published sensor values and the number of advertisements taken as scale frames
+static void test_capture(const std::string &name) {
+  auto capture = load_capture(std::string(CAPTURE_DIR) + "/" + name + ".log");
+  auto want = read_lines(std::string(CAPTURE_DIR) + "/" + name + ".expected");
+  TestScale t;
+  size_t parsed = t.replay(capture);
+  std::vector<std::string> got = published;
+  got.push_back("parsed " + std::to_string(parsed));
+  check_sequence(name.c_str(), got, want);
+}
+
+// rebroadcasts are dropped before the stability filter, more of them change nothing
+static void test_rebroadcasts(const std::string &name) {
+  auto capture = load_capture(std::string(CAPTURE_DIR) + "/" + name + ".log");
+  TestScale once;
+  once.replay(capture);
+  std::vector<std::string> want = published;
+
+  std::vector<Advertisement> doubled;
+  for (auto &adv : capture) {
+    doubled.push_back(adv);
+    doubled.push_back(adv);
+  }
+  TestScale twice;
+  twice.replay(doubled);
+  check_sequence("rebroadcasts", published, want);
+}
+
+// going back to idle restores the tracker's own setting
+static void test_tracker_not_continuous(const std::string &name) {
+  auto capture = load_capture(std::string(CAPTURE_DIR) + "/" + name + ".log");
+  TestScale t(false);
+  t.replay(capture);
+  std::vector<std::string> switches;
+  for (auto &p : published) {
+    if (p.rfind("tracker ", 0) == 0)
+      switches.push_back(p);
+  }
+  check_sequence("tracker continuous", switches,
+                 {"tracker continuous 1", "tracker continuous 0", "tracker continuous 1", "tracker continuous 0"});
+  CHECK(!t.tracker.scan_continuous);
+}
+
+static void test_edge_cases() {
+  {
+    // the payload may carry the MAC in either byte order
+    TestScale t;
+    for (uint8_t seq = 1; seq <= 3; seq++)
+      CHECK(t.receive({1000u + seq * 300u, TEST_SCALE_ADDRESS, es_cs20m_frame(seq, 72.5f, true, true)}));
+    CHECK(t.weight.state == 72.5f);
+  }
+  {
+    // a stable frame out of tolerance restarts the count
+    TestScale t;
+    t.receive({1000, TEST_SCALE_ADDRESS, es_cs20m_frame(1, 72.50f, true)});
+    t.receive({1300, TEST_SCALE_ADDRESS, es_cs20m_frame(2, 72.50f, true)});
+    t.receive({1600, TEST_SCALE_ADDRESS, es_cs20m_frame(3, 72.80f, true)});
+    t.receive({1900, TEST_SCALE_ADDRESS, es_cs20m_frame(4, 72.80f, true)});
+    CHECK(std::count(published.begin(), published.end(), "weight 72.80") == 0);
+    t.receive({2200, TEST_SCALE_ADDRESS, es_cs20m_frame(5, 72.80f, true)});
+    CHECK(std::count(published.begin(), published.end(), "weight 72.80") == 1);
+  }
+  {
+    // one reading per session, a new session after session_timeout of silence publishes again
+    TestScale t;
+    for (uint8_t seq = 1; seq <= 5; seq++)
+      t.receive({1000u + seq * 300u, TEST_SCALE_ADDRESS, es_cs20m_frame(seq, 72.5f, true)});
+    CHECK(std::count(published.begin(), published.end(), "weight 72.50") == 1);
+    for (uint8_t seq = 6; seq <= 8; seq++)
+      t.receive({20000u + seq * 300u, TEST_SCALE_ADDRESS, es_cs20m_frame(seq, 72.5f, true)});
+    CHECK(std::count(published.begin(), published.end(), "weight 72.50") == 2);
+  }
+  {
+    // short frames and other advertisers are not parsed
+    TestScale t;
+    auto frame = es_cs20m_frame(1, 72.5f, true);
+    CHECK(!t.receive({1000, TEST_SCALE_ADDRESS + 1, frame}));
+    frame.pop_back();
+    CHECK(!t.receive({1000, TEST_SCALE_ADDRESS, frame}));
+  }
+}
+
+int main() {
+  test_capture("weigh_ins");
+  test_rebroadcasts("weigh_ins");
+  test_tracker_not_continuous("weigh_ins");
+  test_edge_cases();
+  if (failures) {
+    std::fprintf(stderr, "%d failures\n", failures);
+    return 1;
+  }
+  std::printf("renpho replay: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+
+namespace esphome {
+namespace esp32_ble_tracker {
+
+struct ESPBTUUID {
+  uint16_t uuid;
+};
+
+struct ServiceData {
+  ESPBTUUID uuid;
+  std::vector<uint8_t> data;
+};
+
+// one advertisement, filled in by the test
+class ESPBTDevice {
+ public:
+  uint64_t address_uint64() const { return this->address; }
+  const std::vector<ServiceData> &get_manufacturer_datas() const { return this->manufacturer_datas; }
+
+  uint64_t address{0};
+  std::vector<ServiceData> manufacturer_datas;
+};
+
+// records scan restarts in sensor::published as "tracker continuous <0|1>"
+class ESP32BLETracker : public Component {
+ public:
+  void set_scan_interval(uint32_t scan_interval) { this->scan_interval = scan_interval; }
+  void set_scan_window(uint32_t scan_window) { this->scan_window = scan_window; }
+  void set_scan_continuous(bool scan_continuous) {
+    this->scan_continuous = scan_continuous;
+    sensor::published.push_back(std::string("tracker continuous ") + (scan_continuous ? "1" : "0"));
+  }
+  void stop_scan() { this->scan_continuous = false; }
+
+  uint32_t scan_interval{0};
+  uint32_t scan_window{0};
+  bool scan_continuous{true};
+};
+
+class ESPBTDeviceListener {
+ public:
+  virtual ~ESPBTDeviceListener() = default;
+  virtual bool parse_device(const ESPBTDevice &device) = 0;
+  void set_parent(ESP32BLETracker *parent) { this->parent_ = parent; }
+
+ protected:
+  ESP32BLETracker *parent_{nullptr};
+};
+
+}  // namespace esp32_ble_tracker
+}  // namespace esphome
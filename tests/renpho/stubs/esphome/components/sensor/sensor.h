@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace sensor {
+
+// every publish of every sensor, in order, as "<name> <value>"
+inline std::vector<std::string> published;
+
+class Sensor {
+ public:
+  explicit Sensor(const char *name) : name_(name) {}
+
+  void publish_state(float state) {
+    this->state = state;
+    char value[32];
+    std::snprintf(value, sizeof(value), "%.2f", state);
+    published.push_back(this->name_ + " " + value);
+  }
+
+  float state{0.0f};
+
+ protected:
+  std::string name_;
+};
+
+}  // namespace sensor
+}  // namespace esphome
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include "esphome/core/hal.h"
+
+namespace esphome {
+
+namespace setup_priority {
+const float DATA = 600.0f;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return 0.0f; }
+
+  // moves fake_millis to ms, running each timeout due by then at its own deadline as the scheduler would
+  void advance_to(uint32_t ms) {
+    for (;;) {
+      auto next = this->timeouts_.end();
+      for (auto it = this->timeouts_.begin(); it != this->timeouts_.end(); ++it) {
+        if (static_cast<int32_t>(ms - it->second.first) >= 0 &&
+            (next == this->timeouts_.end() || static_cast<int32_t>(it->second.first - next->second.first) < 0))
+          next = it;
+      }
+      if (next == this->timeouts_.end())
+        break;
+      fake_millis = next->second.first;
+      auto f = std::move(next->second.second);
+      this->timeouts_.erase(next);
+      f();
+    }
+    fake_millis = ms;
+  }
+
+ protected:
+  void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {
+    this->timeouts_[name] = {millis() + timeout, std::move(f)};
+  }
+
+  std::map<std::string, std::pair<uint32_t, std::function<void()>>> timeouts_;
+};
+
+}  // namespace esphome